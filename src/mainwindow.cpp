@@ -1,5 +1,7 @@
 #include "mainwindow.h"
 #include "settingsdialog.h"
+#include "tankmapping.h"
+#include "replaysnapshot.h"
 #include "ui_mainwindow.h"
 #include <QProcess>
 #include <QMessageBox>
@@ -9,14 +11,18 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
-#include <QTableWidgetItem>
+#include <QItemSelectionModel>
+#include <QScrollBar>
+#include <QHeaderView>
+#include <QFontMetrics>
+#include <QStyle>
 #include <QLabel>
 #include <QSet>
-#include <QtSql/QSqlError>
-#include <QtSql/QSqlDatabase>
-#include <QtSql/QSqlQuery>
 #include <QVariant>
 #include <QLocale>
+#include <QFutureWatcher>
+#include <algorithm>
+#include <QtConcurrent/QtConcurrentRun>
 
 
 MainWIndow::MainWIndow(QWidget *parent)
@@ -26,6 +32,11 @@ MainWIndow::MainWIndow(QWidget *parent)
     , m_fileWatcher(new QFileSystemWatcher(this))
     , m_workerThread(new QThread(this))
     , m_scanner(nullptr)
+    , m_progressTimer(new QTimer(this))
+    , m_databaseThread(new QThread(this))
+    , m_database(nullptr)
+    , m_searchTimer(new QTimer(this))
+    , m_replayModel(new ReplayTableModel(this))
 {
     ui->setupUi(this);
     setupUiAndConnections();
@@ -40,10 +51,22 @@ MainWIndow::~MainWIndow()
         m_workerThread->wait();
     }
 
-    // Close the database connection cleanly
-    if (QSqlDatabase::contains("qt_sql_default_connection")) {
-        QSqlDatabase::database().close();
-        QSqlDatabase::removeDatabase("qt_sql_default_connection");
+    // Let a snapshot write in flight finish, so the next launch does not find a stale file
+    m_snapshotWrite.waitForFinished();
+    if (m_snapshotDirty) {
+        m_snapshotDirty = false;
+        writeSnapshot();
+        m_snapshotWrite.waitForFinished();
+    }
+
+    // Commit pending cache writes and close the connection on its own thread before stopping it
+    if (m_database) {
+        if (m_databaseThread->isRunning()) {
+            QMetaObject::invokeMethod(m_database, &ReplayDatabase::close, Qt::BlockingQueuedConnection);
+            m_databaseThread->quit();
+            m_databaseThread->wait();
+        }
+        delete m_database;
     }
 
     delete ui;
@@ -51,39 +74,42 @@ MainWIndow::~MainWIndow()
 }
 
 /**
- * @brief Initializes the SQLite database connection and creates the replays table.
- * @return true if successful, false otherwise.
+ * @brief Starts the replay cache service on its own thread and asks it to open the database.
+ * Loading continues in onDatabaseOpened.
  */
-bool MainWIndow::initializeDatabase()
+void MainWIndow::initializeDatabase()
 {
-    // Set up a database connection named "qt_sql_default_connection"
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName(m_cacheFilePath);
+    m_database = new ReplayDatabase(m_cacheFilePath);
+    m_database->moveToThread(m_databaseThread);
+
+    connect(m_database, &ReplayDatabase::opened, this, &MainWIndow::onDatabaseOpened, Qt::QueuedConnection);
+    connect(m_database, &ReplayDatabase::replaysLoaded, this, &MainWIndow::onReplayCacheLoaded, Qt::QueuedConnection);
+    connect(m_database, &ReplayDatabase::replayPageLoaded, this, &MainWIndow::onReplayPageLoaded, Qt::QueuedConnection);
+    connect(m_database, &ReplayDatabase::searchFinished, this, &MainWIndow::onSearchFinished, Qt::QueuedConnection);
+    // Committed rows may add or drop full-text matches, so an active word filter is asked again
+    connect(m_database, &ReplayDatabase::writesCommitted, this, [this]() {
+        if (!m_searchFilter.fullTextQuery().isEmpty()) {
+            m_searchTimer->start();
+        }
+    }, Qt::QueuedConnection);
 
-    if (!db.open()) {
-        qCritical() << "Error: Failed to connect to database:" << db.lastError().text();
-        return false;
-    }
+    m_databaseThread->start();
+    QMetaObject::invokeMethod(m_database, &ReplayDatabase::open, Qt::QueuedConnection);
+}
 
-    QSqlQuery query;
-    // Create the replays table if it doesn't exist.
-    if (!query.exec(
-            "CREATE TABLE IF NOT EXISTS replays ("
-            "path TEXT PRIMARY KEY, "
-            "playerName TEXT, "
-            "tank TEXT, "
-            "map TEXT, "
-            "date TEXT, "
-            "damage INTEGER, "
-            "server TEXT, "
-            "version TEXT"
-            ")"
-            )) {
-        qCritical() << "Error creating replays table:" << query.lastError().text();
-        return false;
-    }
+void MainWIndow::onDatabaseOpened(bool ok)
+{
+    m_databaseReady = ok;
 
-    return true;
+    if (ok && !replays_directory.isEmpty()) {
+        m_fileWatcher->addPath(replays_directory);
+        loadReplayCache(); // 1. Load existing data for fast display; the scan starts once it arrives
+    } else if (!replays_directory.isEmpty()){
+        statusBar()->showMessage("Database initialization failed. Performing full scan...", 5000);
+        startReplayScan(false);
+    } else {
+        statusBar()->showMessage("Please configure the replay directory in Settings.", 5000);
+    }
 }
 
 void MainWIndow::setupUiAndConnections()
@@ -97,6 +123,12 @@ void MainWIndow::setupUiAndConnections()
 
     // Set up SQLite cache file path
     m_cacheFilePath = configDir + "/replays_cache.sqlite";
+    m_snapshotFilePath = configDir + "/replays_snapshot.bin";
+
+    // Build the shared tank mapping up front so no scanner pays for it mid-scan
+    const TankMapping& tankMapping = TankMapping::instance();
+    qInfo() << "Startup: tank mapping ready in" << tankMapping.loadTimeMs() << "ms with"
+            << tankMapping.overrideCount() << "user overrides";
 
     settings = new QSettings(configPath, QSettings::IniFormat);
 
@@ -105,12 +137,12 @@ void MainWIndow::setupUiAndConnections()
     bottle_name = settings->value("bottle_name", "WindowsGames").toString();
     client_version_xml_path = settings->value("client_version_xml_path", "").toString();
 
-    ui->replayTableWidget->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->replayTableWidget->setSortingEnabled(true);
-    ui->replayTableWidget->horizontalHeader()->setSectionsClickable(true);
-    ui->replayTableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->replayTableWidget->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->replayTableWidget->setColumnCount(7);
+    ui->replayTableView->setModel(m_replayModel);
+    ui->replayTableView->setSortingEnabled(true);
+    ui->replayTableView->sortByColumn(ReplayTableModel::DateColumn, Qt::DescendingOrder); // Newest battles first
+    ui->replayTableView->horizontalHeader()->setSectionsClickable(true);
+    ui->replayTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->replayTableView->setSelectionMode(QAbstractItemView::SingleSelection);
     ui->launchButton->setEnabled(false);
 
     QLabel* reportLabel = new QLabel("<a href='https://github.com/vorlie/WoT-Replay-Manager/issues/new?template=tank_mapping.yml'>Report Incorrect Tank Name</a>", this);
@@ -127,153 +159,227 @@ void MainWIndow::setupUiAndConnections()
     aboutLabel->setContentsMargins(10, 0, 0, 5);
 
     // Connect signals for the main UI
-    connect(ui->replayTableWidget, &QTableWidget::itemSelectionChanged, this, &MainWIndow::on_replayTableWidget_itemSelectionChanged);
+    connect(ui->replayTableView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWIndow::onReplaySelectionChanged);
 
     // Connect the file system watcher
     connect(m_fileWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWIndow::onReplayDirectoryChanged);
 
-    if (initializeDatabase() && !replays_directory.isEmpty()) {
-        m_fileWatcher->addPath(replays_directory);
-        QSet<QString> knownPaths = loadReplayCache(); // 1. Load existing data for fast display
-        startReplayScan(true, knownPaths);  // 2. Start incremental scan to find new files and check for deleted files
-    } else if (!replays_directory.isEmpty()){
-        statusBar()->showMessage("Database initialization failed. Performing full scan...", 5000);
-        startReplayScan(false);
-    } else {
-        statusBar()->showMessage("Please configure the replay directory in Settings.", 5000);
-    }
+    // Sample the scan counters a few times per second, independent of how fast files are parsed
+    m_progressTimer->setInterval(250);
+    connect(m_progressTimer, &QTimer::timeout, this, &MainWIndow::updateScanStatus);
+
+    // Filter on every keystroke; the model evaluates off the GUI thread and drops stale results
+    connect(ui->filterLineEdit, &QLineEdit::textChanged, this, &MainWIndow::onFilterTextChanged);
+    connect(m_replayModel, &ReplayTableModel::filterApplied, this, &MainWIndow::onFilterApplied);
+
+    // Words go through the full-text index once typing pauses; bounds-only filters apply at once
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(120);
+    connect(m_searchTimer, &QTimer::timeout, this, &MainWIndow::startFullTextSearch);
+
+    // Paint the first screen from the mapped snapshot; SQLite catches up in the background
+    showSnapshot();
+    initializeDatabase();
 }
 
 /**
- * @brief Loads replay metadata from the SQLite database and updates the table.
- * @return A QSet of all replay paths currently present in the cache.
+ * @brief Fills the empty table with the newest rows of the binary snapshot, if there is one.
  */
-QSet<QString> MainWIndow::loadReplayCache()
+void MainWIndow::showSnapshot()
 {
-    replaysData.clear(); // Clear the current in-memory list
-    QSet<QString> cachePaths; // To store paths currently in the DB
+    constexpr int kFirstScreenRows = 200;
 
-    QSqlQuery query("SELECT path, playerName, tank, map, date, damage, server, version FROM replays");
+    QElapsedTimer timer;
+    timer.start();
 
-    if (!query.exec()) {
-        qCritical() << "Error selecting replays:" << query.lastError().text();
-        return cachePaths;
+    ReplaySnapshot snapshot;
+    if (replays_directory.isEmpty() || !snapshot.open(m_snapshotFilePath)) {
+        return;
     }
 
-    while (query.next()) {
-        ReplayInfo info;
-        // Map query result columns to ReplayInfo members
-        info.path = query.value(0).toString();
-        info.playerName = query.value(1).toString();
-        info.tank = query.value(2).toString();
-        info.map = query.value(3).toString();
-        info.date = query.value(4).toString();
-        info.damage = query.value(5).toInt(); // Ensure damage is read as an integer
-        info.server = query.value(6).toString();
-        info.version = query.value(7).toString();
-
-        // Only load data into the table if the file still exists on disk
-        if (QFile::exists(info.path)) {
-            replaysData.append(info);
-        }
+    mergeReplays(snapshot.replays(0, kFirstScreenRows));
+    qInfo() << "Startup: showed" << m_replayModel->replayCount() << "of" << snapshot.rowCount()
+            << "snapshot rows in" << timer.elapsed() << "ms";
+}
 
-        // Always add to cachePaths set, even if the file is deleted (we need this to detect stale entries)
-        cachePaths.insert(info.path);
+/**
+ * @brief Rewrites the binary snapshot from the current replay list on a pool thread.
+ * Only one write runs at a time; a request made meanwhile is served once it finishes, from
+ * the replay list as it is then, so an older snapshot can never be committed last.
+ */
+void MainWIndow::writeSnapshot()
+{
+    if (m_snapshotWrite.isRunning()) {
+        m_snapshotDirty = true;
+        return;
     }
 
-    updateTable(replaysData);
-    statusBar()->showMessage("Loaded " + QString::number(replaysData.size()) + " replays from cache.", 3000);
-    return cachePaths;
+    auto* watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        if (m_snapshotDirty) {
+            m_snapshotDirty = false;
+            writeSnapshot();
+        }
+    });
+
+    m_snapshotWrite = QtConcurrent::run([filePath = m_snapshotFilePath, replays = m_replayModel->replays()]() mutable {
+        // Newest first, so the first screen at the next launch is the head of the file
+        std::sort(replays.begin(), replays.end(), [](const ReplayInfo& a, const ReplayInfo& b) {
+            return a.battleTime > b.battleTime;
+        });
+        ReplaySnapshot::write(filePath, replays);
+    });
+    watcher->setFuture(m_snapshotWrite);
 }
 
 /**
- * @brief Deletes replay entries from the database whose files no longer exist on disk.
- * @param pathsToDelete A QSet of absolute file paths to remove from the DB.
+ * @brief Asks the database thread for all cached replays. They arrive in onReplayCacheLoaded.
+ * On an empty view the newest page is requested first, so the first screen is ordered and
+ * filled by SQLite before the full library has been read.
  */
-void MainWIndow::deleteStaleReplayCacheEntries(const QSet<QString>& pathsToDelete)
+void MainWIndow::loadReplayCache()
 {
-    if (pathsToDelete.isEmpty()) {
+    if (!m_databaseReady) {
         return;
     }
 
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) {
-        qWarning() << "Database not open for deleting stale entries.";
-        return;
+    if (m_replayModel->replayCount() == 0) {
+        ReplayQuery firstPage;
+        firstPage.sortColumn = ReplayQuery::SortByDate;
+        firstPage.sortOrder = Qt::DescendingOrder;
+        QMetaObject::invokeMethod(m_database, [database = m_database, firstPage]() {
+            database->queryReplays(firstPage);
+        }, Qt::QueuedConnection);
     }
+    QMetaObject::invokeMethod(m_database, &ReplayDatabase::loadReplays, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Shows a page of replays selected and ordered by the database.
+ */
+void MainWIndow::onReplayPageLoaded(const ReplayQuery& query, const QList<ReplayInfo>& replays, int totalCount)
+{
+    Q_UNUSED(query);
 
-    if (!db.transaction()) {
-        qCritical() << "Failed to start transaction for cleanup:" << db.lastError().text();
+    // Only used to fill an empty view; once the full cache has arrived it owns the table
+    if (m_replayModel->replayCount() > 0) {
         return;
     }
 
-    QSqlQuery query;
-    QString placeholders = pathsToDelete.values().join("','");
-    QString deleteQuery = QString("DELETE FROM replays WHERE path IN ('%1')").arg(placeholders);
+    mergeReplays(replays);
+    statusBar()->showMessage(QString("Loading %1 cached replays...").arg(totalCount));
+}
 
-    if (query.exec(deleteQuery)) {
-        if (db.commit()) {
-            qDebug() << "Successfully deleted" << pathsToDelete.size() << "stale entries from cache.";
-        } else {
-            qCritical() << "Failed to commit cleanup transaction:" << db.lastError().text();
-            db.rollback();
-        }
+/**
+ * @brief Shows the cached replays, then starts an incremental scan for new and changed files.
+ */
+void MainWIndow::onReplayCacheLoaded(const QList<ReplayInfo>& replays)
+{
+    // Show every cached row right away; the scan's syncWithDisk drops the ones whose file is gone
+    if (m_replayModel->replayCount() == 0) {
+        updateTable(replays);
     } else {
-        qCritical() << "Error executing delete query for stale entries:" << query.lastError().text();
-        db.rollback();
+        // Rows from the snapshot, the first page or an earlier load are refreshed in place instead of rebuilt
+        QSet<QString> cachedPaths;
+        cachedPaths.reserve(replays.size());
+        for (const ReplayInfo& info : replays) {
+            cachedPaths.insert(info.path);
+        }
+        QSet<QString> uncachedPaths;
+        for (const QString& path : m_replayModel->paths()) {
+            if (!cachedPaths.contains(path)) {
+                uncachedPaths.insert(path);
+            }
+        }
+        removeReplays(uncachedPaths);
+        mergeReplays(replays);
+    }
+
+    m_cacheIndex.clear();
+    m_cacheIndex.reserve(replays.size());
+    for (const ReplayInfo& info : replays) {
+        m_cacheIndex.insert(info.path, info.fingerprint);
     }
+
+    statusBar()->showMessage("Loaded " + QString::number(m_replayModel->replayCount()) + " replays from cache.", 3000);
+
+    // 2. Start incremental scan to find new files and check for deleted files. It lists the
+    // directory once and diffs it in syncWithDisk, so no separate existence check runs here.
+    startReplayScan(true, m_cacheIndex);
 }
 
 /**
- * @brief Inserts or updates replay metadata into the SQLite database using a transaction.
- * @param replays The list of new/updated replay data to save.
+ * @brief Checks which cached replays are no longer on disk without blocking the GUI thread.
+ * The replay directory is enumerated once on a pool thread and diffed against a snapshot of
+ * the cache index; missing replays are then removed on the GUI thread.
+ * @param onFinished Optional callback receiving the paths that were removed.
  */
-void MainWIndow::saveReplayCache(const QList<ReplayInfo>& replays)
+void MainWIndow::verifyCachedReplays(std::function<void(const QSet<QString>&)> onFinished)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) {
-        qWarning() << "Database not open for saving.";
+    if (replays_directory.isEmpty()) {
         return;
     }
 
-    // Start transaction for speed and atomicity
-    if (!db.transaction()) {
-        qCritical() << "Failed to start transaction:" << db.lastError().text();
-        return;
-    }
+    const QString replaysDir = replays_directory;
+    const QStringList cachedPaths = m_cacheIndex.keys();
+
+    auto* watcher = new QFutureWatcher<QSet<QString>>(this);
+    connect(watcher, &QFutureWatcher<QSet<QString>>::finished, this, [this, watcher, onFinished]() {
+        const QSet<QString> missingPaths = watcher->result();
+        watcher->deleteLater();
+
+        removeStaleReplays(missingPaths);
+        if (onFinished) {
+            onFinished(missingPaths);
+        }
+    });
+
+    watcher->setFuture(QtConcurrent::run([replaysDir, cachedPaths]() {
+        QSet<QString> diskPaths;
+        for (const auto& fileInfo : ReplayScanner::replayFiles(replaysDir)) {
+            diskPaths.insert(fileInfo.absoluteFilePath());
+        }
 
-    QSqlQuery query;
-    // Uses INSERT OR REPLACE INTO: if a replay with the same path (PRIMARY KEY) exists, it updates it.
-    query.prepare(
-        "INSERT OR REPLACE INTO replays (path, playerName, tank, map, date, damage, server, version) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?)"
-        );
-
-    for (const auto& info : replays) {
-        query.bindValue(0, info.path);
-        query.bindValue(1, info.playerName);
-        query.bindValue(2, info.tank);
-        query.bindValue(3, info.map);
-        query.bindValue(4, info.date);
-        query.bindValue(5, info.damage);
-        query.bindValue(6, info.server);
-        query.bindValue(7, info.version);
-        if (!query.exec()) {
-            qCritical() << "Error inserting/replacing replay:" << query.lastError().text();
-            db.rollback();
-            return;
+        QSet<QString> missingPaths;
+        for (const QString& path : cachedPaths) {
+            if (!diskPaths.contains(path)) {
+                missingPaths.insert(path);
+            }
         }
+        return missingPaths;
+    }));
+}
+
+/**
+ * @brief Queues the removal of replays whose files no longer exist on disk.
+ * @param pathsToDelete A QSet of absolute file paths to remove from the DB.
+ */
+void MainWIndow::deleteStaleReplayCacheEntries(const QSet<QString>& pathsToDelete)
+{
+    if (pathsToDelete.isEmpty() || !m_databaseReady) {
+        return;
     }
+    QMetaObject::invokeMethod(m_database, [database = m_database, pathsToDelete]() {
+        database->deleteReplays(pathsToDelete);
+    }, Qt::QueuedConnection);
+}
 
-    if (db.commit()) {
-        qDebug() << "Replay cache updated successfully with" << replays.size() << "new/updated entries.";
-    } else {
-        qCritical() << "Failed to commit transaction:" << db.lastError().text();
-        db.rollback();
+/**
+ * @brief Queues new or updated replays for the database thread, which commits them in batched transactions.
+ * @param replays The list of new/updated replay data to save.
+ */
+void MainWIndow::saveReplayCache(const QList<ReplayInfo>& replays)
+{
+    if (replays.isEmpty() || !m_databaseReady) {
+        return;
     }
+    QMetaObject::invokeMethod(m_database, [database = m_database, replays]() {
+        database->saveReplays(replays);
+    }, Qt::QueuedConnection);
 }
 
-void MainWIndow::startReplayScan(bool incremental, const QSet<QString>& knownPaths)
+void MainWIndow::startReplayScan(bool incremental, const QHash<QString, ReplayFingerprint>& knownReplays)
 {
     if (m_workerThread->isRunning()) {
         qDebug() << "Scan already in progress. Ignoring new request.";
@@ -298,11 +404,15 @@ void MainWIndow::startReplayScan(bool incremental, const QSet<QString>& knownPat
     // Create a new scanner instance
     m_scanner = new ReplayScanner(replays_directory);
 
+    // "scan_threads" <= 0 means one worker per available core
+    int scanThreads = settings->value("scan_threads", 0).toInt();
+    m_scanner->setMaxThreadCount(scanThreads > 0 ? scanThreads : QThread::idealThreadCount());
+
     if (incremental) {
-        m_scanner->setKnownReplayPaths(knownPaths);
+        m_scanner->setKnownReplays(knownReplays);
         statusBar()->showMessage("Starting incremental scan for new files...");
     } else {
-        m_scanner->setKnownReplayPaths({});
+        m_scanner->setKnownReplays({});
         statusBar()->showMessage("Starting full scan (parsing all files)...");
     }
 
@@ -316,8 +426,12 @@ void MainWIndow::startReplayScan(bool incremental, const QSet<QString>& knownPat
 
     // Connect signals
     connect(m_workerThread, &QThread::started, m_scanner, &ReplayScanner::doScan, Qt::QueuedConnection);
+    connect(m_scanner, &ReplayScanner::replaysParsed, this, &MainWIndow::onReplaysParsed, Qt::QueuedConnection);
     connect(m_scanner, &ReplayScanner::scanFinished, this, &MainWIndow::onReplayScanFinished, Qt::QueuedConnection);
-    connect(m_scanner, &ReplayScanner::scanProgress, this, &MainWIndow::onReplayScanProgress, Qt::QueuedConnection);
+    if (m_databaseReady) {
+        // Battle results are only stored, never shown, so they go straight to the database thread
+        connect(m_scanner, &ReplayScanner::battleResultsParsed, m_database, &ReplayDatabase::saveBattleResults, Qt::QueuedConnection);
+    }
     connect(m_scanner, &ReplayScanner::scanFinished, m_workerThread, &QThread::quit, Qt::QueuedConnection);
     connect(m_workerThread, &QThread::finished, this, [this]() {
         // Clean up the scanner object when the thread finishes
@@ -327,122 +441,284 @@ void MainWIndow::startReplayScan(bool incremental, const QSet<QString>& knownPat
         }
     }, Qt::QueuedConnection);
 
+    m_scanProgress = m_scanner->progress();
+    m_scanClock.start();
+    m_progressTimer->start();
+
     m_workerThread->start();
 }
 
-void MainWIndow::onReplayScanFinished(const QList<ReplayInfo>& newReplays)
+/**
+ * @brief Stores a batch of freshly parsed replays and shows them right away, while the scan continues.
+ */
+void MainWIndow::onReplaysParsed(const QList<ReplayInfo>& replays)
 {
-    qDebug() << "Received scan results, new/updated replays found:" << newReplays.size();
+    qDebug() << "Received scan batch, new/updated replays:" << replays.size();
 
-    if (!newReplays.isEmpty()) {
-        // 1. Save the newly scanned replays (will INSERT or REPLACE existing entries)
-        saveReplayCache(newReplays);
+    // Save the batch (will INSERT or REPLACE existing entries) and add it to the view
+    saveReplayCache(replays);
+    for (const ReplayInfo& info : replays) {
+        m_cacheIndex.insert(info.path, info.fingerprint);
+    }
+    mergeReplays(replays);
+}
+
+/**
+ * @brief Narrows the table to the replays matching the filter bar.
+ */
+void MainWIndow::onFilterTextChanged(const QString& text)
+{
+    m_searchFilter = ReplayFilter::parse(text);
+    if (!m_databaseReady || m_searchFilter.fullTextQuery().isEmpty()) {
+        // Nothing for the index to answer; the model matches the words as substrings
+        m_searchTimer->stop();
+        ++m_searchRequestId;
+        m_replayModel->setFilter(m_searchFilter);
+        return;
     }
+    m_searchTimer->start();
+}
+
+/**
+ * @brief Asks the database which replays match the filter bar's words.
+ */
+void MainWIndow::startFullTextSearch()
+{
+    const quint64 requestId = ++m_searchRequestId;
+    const QString text = m_searchFilter.fullTextQuery();
+    QMetaObject::invokeMethod(m_database, [database = m_database, text, requestId]() {
+        database->searchReplays(text, requestId);
+    }, Qt::QueuedConnection);
+}
 
-    // 2. Perform file system synchronization to detect deleted files
-    QDir dir(replays_directory);
-    QStringList filters;
-    filters << "*.wotreplay";
-    QFileInfoList fileList = dir.entryInfoList(filters, QDir::Files | QDir::NoDotAndDotDot);
+void MainWIndow::onSearchFinished(quint64 requestId, bool ok, const QSet<QString>& matchingPaths)
+{
+    if (requestId != m_searchRequestId) {
+        return; // The filter changed while the index was searched
+    }
+    ReplayFilter filter = m_searchFilter;
+    if (ok) {
+        filter.fullTextMatches = matchingPaths;
+    }
+    m_replayModel->setFilter(filter);
+}
 
-    QSet<QString> allDiskPaths;
-    for (const auto& fileInfo : fileList) {
-        allDiskPaths.insert(fileInfo.absoluteFilePath());
+void MainWIndow::onFilterApplied(int shownCount, int totalCount)
+{
+    if (m_replayModel->filter().isEmpty()) {
+        statusBar()->clearMessage();
+        return;
     }
+    QLocale locale = QLocale::system();
+    statusBar()->showMessage(QString("%1 of %2 replays match the filter.").arg(locale.toString(shownCount), locale.toString(totalCount)));
+}
 
-    // Get all paths currently stored in the cache
-    QSet<QString> allCachePaths = loadReplayCache();
+void MainWIndow::onReplayScanFinished(const QSet<QString>& diskPaths)
+{
+    m_progressTimer->stop();
+    if (m_scanProgress) {
+        qDebug() << "Scan finished in" << m_scanClock.elapsed() << "ms:"
+                 << m_scanProgress->enumerated.load() << "files,"
+                 << m_scanProgress->skipped.load() << "skipped,"
+                 << m_scanProgress->parsed.load() << "parsed,"
+                 << m_scanProgress->failed.load() << "failed,"
+                 << m_scanProgress->bytesRead.load() << "bytes read";
+        m_scanProgress.reset();
+    }
+
+    // New and updated replays have already arrived through onReplaysParsed;
+    // only deletions are left to reconcile
+    syncWithDisk(diskPaths);
+    writeSnapshot();
+
+    statusBar()->showMessage("Scan and synchronization complete! Found " + QString::number(m_replayModel->replayCount()) + " total replays.", 5000);
+}
 
+/**
+ * @brief Diffs the on-disk replay set against the in-memory cache index and drops the replays
+ * whose files are gone, from the database and from the view, without reloading either.
+ * @return The paths that were removed.
+ */
+QSet<QString> MainWIndow::syncWithDisk(const QSet<QString>& diskPaths)
+{
     QSet<QString> pathsToDelete;
-    for (const QString& path : allCachePaths) {
+    for (auto it = m_cacheIndex.constBegin(); it != m_cacheIndex.constEnd(); ++it) {
         // If a path exists in the cache but NOT on disk, it needs to be deleted from the cache
-        if (!allDiskPaths.contains(path)) {
-            pathsToDelete.insert(path);
+        if (!diskPaths.contains(it.key())) {
+            pathsToDelete.insert(it.key());
         }
     }
 
-    // 3. Delete stale entries from the database
-    deleteStaleReplayCacheEntries(pathsToDelete);
+    removeStaleReplays(pathsToDelete);
+    return pathsToDelete;
+}
 
-    // 4. Reload the table after sync
-    loadReplayCache();
+/**
+ * @brief Drops replays whose files are gone from the database, the cache index and the view.
+ */
+void MainWIndow::removeStaleReplays(const QSet<QString>& paths)
+{
+    if (paths.isEmpty()) {
+        return;
+    }
 
-    statusBar()->showMessage("Scan and synchronization complete! Found " + QString::number(replaysData.size()) + " total replays.", 5000);
+    deleteStaleReplayCacheEntries(paths);
+    for (const QString& path : paths) {
+        m_cacheIndex.remove(path);
+    }
+    removeReplays(paths);
 }
 
-void MainWIndow::onReplayScanProgress(const QString& currentFile)
+/**
+ * @brief Shows scan throughput and ETA from the scanner's counters. Driven by m_progressTimer.
+ */
+void MainWIndow::updateScanStatus()
 {
-    statusBar()->showMessage("Scanning: " + currentFile);
+    if (!m_scanProgress) {
+        return;
+    }
+
+    const ScanProgress& progress = *m_scanProgress;
+    QLocale locale = QLocale::system();
+
+    if (!progress.enumerationDone.load(std::memory_order_acquire)) {
+        statusBar()->showMessage("Scanning: " + locale.toString(progress.enumerated.load(std::memory_order_relaxed)) + " files found...");
+        return;
+    }
+
+    const qint64 queued = progress.queued.load(std::memory_order_relaxed);
+    const qint64 done = progress.parsed.load(std::memory_order_relaxed) + progress.failed.load(std::memory_order_relaxed);
+    const qint64 bytesRead = progress.bytesRead.load(std::memory_order_relaxed);
+    const double seconds = qMax(0.001, m_scanClock.elapsed() / 1000.0);
+
+    const double filesPerSecond = done / seconds;
+    const double megabytesPerSecond = bytesRead / seconds / (1024.0 * 1024.0);
+
+    QString message = QString("Scanning: %1 / %2 parsed (%3 files/s, %4 MB/s")
+                          .arg(locale.toString(done), locale.toString(queued),
+                               locale.toString(filesPerSecond, 'f', 0), locale.toString(megabytesPerSecond, 'f', 1));
+    if (filesPerSecond > 0 && done < queued) {
+        const qint64 etaSeconds = qint64((queued - done) / filesPerSecond);
+        message += QString(", ETA %1:%2").arg(etaSeconds / 60).arg(etaSeconds % 60, 2, 10, QChar('0'));
+    }
+    message += ")";
+
+    statusBar()->showMessage(message);
 }
 
 void MainWIndow::onReplayDirectoryChanged(const QString& path)
 {
     qDebug() << "Replay directory content changed in:" << path;
-    startReplayScan(true);
+
+    // Hand the scanner the fingerprints we already hold so only new or rewritten files get parsed
+    startReplayScan(true, m_cacheIndex);
 }
 
+/**
+ * @brief Replaces the table contents with a single model reset.
+ */
 void MainWIndow::updateTable(const QList<ReplayInfo>& replays)
 {
-    ui->replayTableWidget->clearContents();
-    ui->replayTableWidget->setRowCount(replays.size());
-
-    QStringList labels;
-    labels << "Player" << "Tank" << "Map" << "Date" << "Damage" << "Server" << "Version";
-    ui->replayTableWidget->setHorizontalHeaderLabels(labels);
-
-    QLocale locale = QLocale::system();
-
-    for (int row = 0; row < replays.size(); ++row) {
-        const ReplayInfo& info = replays[row];
-        QTableWidgetItem* item;
-
-        // Column 0: Player Name
-        item = new QTableWidgetItem(info.playerName);
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        // Store the full replay path in the UserRole for launching the replay later
-        item->setData(Qt::UserRole, info.path);
-        ui->replayTableWidget->setItem(row, 0, item);
+    m_replayModel->setReplays(replays);
+    updateColumnWidths(true);
+}
 
-        // Column 1: Tank
-        item = new QTableWidgetItem(info.tank);
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        ui->replayTableWidget->setItem(row, 1, item);
+/**
+ * @brief Adds new replays to the table and refreshes the rows of rewritten ones.
+ * @param replays Replays from a scan batch; paths already in the model are treated as updates.
+ */
+void MainWIndow::mergeReplays(const QList<ReplayInfo>& replays)
+{
+    const bool firstRows = m_replayModel->replayCount() == 0;
+    const QString topPath = scrolledTopPath();
+    m_replayModel->mergeReplays(replays);
+    restoreScrolledTop(topPath);
 
-        // Column 2: Map
-        item = new QTableWidgetItem(info.map);
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        ui->replayTableWidget->setItem(row, 2, item);
+    updateColumnWidths(firstRows);
+}
 
-        // Column 3: Date
-        item = new QTableWidgetItem(info.date);
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        ui->replayTableWidget->setItem(row, 3, item);
+/**
+ * @brief Sizes the columns from a bounded sample instead of measuring every cell: the header,
+ * the rows currently on screen, and the longest text the model has seen in each column.
+ * @param allowShrink Whether columns may get narrower. Without it a column is only widened
+ * when its content has grown past the width last set here, so arriving data neither takes
+ * space from a column the user widened nor re-widens one the user narrowed.
+ */
+void MainWIndow::updateColumnWidths(bool allowShrink)
+{
+    constexpr int kMaxSampledRows = 100;
+
+    QTableView* table = ui->replayTableView;
+    const QFontMetrics metrics = table->fontMetrics();
+    // Same text margin the item delegate draws on each side of a cell
+    const int padding = 2 * (table->style()->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, table) + 1);
+
+    const int firstRow = qMax(0, table->rowAt(0));
+    int lastRow = table->rowAt(table->viewport()->height() - 1);
+    if (lastRow < 0) {
+        lastRow = m_replayModel->rowCount() - 1;
+    }
+    lastRow = qMin(lastRow, firstRow + kMaxSampledRows - 1);
+
+    // The last column stretches to fill the view
+    for (int column = 0; column < ReplayTableModel::ColumnCount - 1; ++column) {
+        int width = table->horizontalHeader()->sectionSizeHint(column);
+        width = qMax(width, metrics.horizontalAdvance(m_replayModel->longestText(column)) + padding);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            const QString text = m_replayModel->index(row, column).data().toString();
+            width = qMax(width, metrics.horizontalAdvance(text) + padding);
+        }
 
-        // Column 4: Damage - Using DamageTableWidgetItem for custom numerical sorting
-        QString formattedDamage = locale.toString(info.damage);
+        // Nothing new to fit: keep whatever width the user chose since the last measurement
+        if (!allowShrink && width <= m_autoColumnWidths[column]) {
+            continue;
+        }
+        m_autoColumnWidths[column] = width;
+        if (allowShrink || width > table->columnWidth(column)) {
+            table->setColumnWidth(column, width);
+        }
+    }
+}
 
-        item = new DamageTableWidgetItem();
-        item->setText(formattedDamage); // Use the locale-formatted string for display
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        item->setData(Qt::UserRole, info.damage); // Store the raw integer for the custom sort operator
-        ui->replayTableWidget->setItem(row, 4, item);
+/**
+ * @brief Removes replays from the table.
+ */
+void MainWIndow::removeReplays(const QSet<QString>& paths)
+{
+    const QString topPath = scrolledTopPath();
+    m_replayModel->removeReplays(paths);
+    restoreScrolledTop(topPath);
+}
 
-        // Column 5: Server
-        item = new QTableWidgetItem(info.server);
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        ui->replayTableWidget->setItem(row, 5, item);
+/**
+ * @brief Returns the replay in the top visible row, or an empty string when the view is not
+ * scrolled down. Rows inserted at the top then show up instead of pushing the view along.
+ */
+QString MainWIndow::scrolledTopPath() const
+{
+    if (ui->replayTableView->verticalScrollBar()->value() == 0) {
+        return QString();
+    }
+    return m_replayModel->pathAt(ui->replayTableView->rowAt(0));
+}
 
-        // Column 6: Version
-        item = new QTableWidgetItem(info.version);
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        ui->replayTableWidget->setItem(row, 6, item);
+/**
+ * @brief Scrolls the view back so that the given replay is the top visible row again.
+ */
+void MainWIndow::restoreScrolledTop(const QString& topPath)
+{
+    if (topPath.isEmpty()) {
+        return;
+    }
+    const int row = m_replayModel->rowForPath(topPath);
+    if (row >= 0) {
+        ui->replayTableView->scrollTo(m_replayModel->index(row, ui->replayTableView->columnAt(0)), QAbstractItemView::PositionAtTop);
     }
-    ui->replayTableWidget->resizeColumnsToContents();
 }
 
-void MainWIndow::on_replayTableWidget_itemSelectionChanged()
+void MainWIndow::onReplaySelectionChanged()
 {
-    bool hasSelection = !ui->replayTableWidget->selectedItems().isEmpty();
+    bool hasSelection = ui->replayTableView->selectionModel()->hasSelection();
     // Enable/disable the launch button based on selection
     ui->launchButton->setEnabled(hasSelection);
 }
@@ -483,64 +759,40 @@ void MainWIndow::on_settingsButton_clicked()
             startReplayScan(false);
         } else if (!replays_directory.isEmpty()) {
             // Directory didn't change, just ensure the current view is loaded and check for new files
-            QSet<QString> knownPaths = loadReplayCache();
-            startReplayScan(true, knownPaths);
+            if (m_databaseReady) {
+                loadReplayCache();
+            } else {
+                startReplayScan(true, m_cacheIndex);
+            }
         }
     }
 }
 
 void MainWIndow::on_cleanupButton_clicked()
 {
-    // Re-use the synchronization logic from the scan finished handler
+    // Re-use the asynchronous existence check from startup
     // This provides a manual way to sync the cache if needed
-
-    // 1. Get all file paths on disk
-    QDir dir(replays_directory);
-    QStringList filters;
-    filters << "*.wotreplay";
-    QFileInfoList fileList = dir.entryInfoList(filters, QDir::Files | QDir::NoDotAndDotDot);
-
-    QSet<QString> allDiskPaths;
-    for (const auto& fileInfo : fileList) {
-        allDiskPaths.insert(fileInfo.absoluteFilePath());
-    }
-
-    // 2. Get all paths currently stored in the cache
-    QSet<QString> allCachePaths = loadReplayCache();
-
-    QSet<QString> pathsToDelete;
-    for (const QString& path : allCachePaths) {
-        // If a path exists in the cache but NOT on disk, it needs to be deleted from the cache
-        if (!allDiskPaths.contains(path)) {
-            pathsToDelete.insert(path);
+    statusBar()->showMessage("Checking cached replays against the replay directory...");
+    verifyCachedReplays([this](const QSet<QString>& removedPaths) {
+        statusBar()->clearMessage();
+        if (!removedPaths.isEmpty()) {
+            writeSnapshot();
+            QMessageBox::information(this, "Cleanup Complete", QString("Removed %1 entries from the database that no longer exist on disk.").arg(removedPaths.size()));
+        } else {
+            QMessageBox::information(this, "Cleanup Complete", "No stale entries found in the database.");
         }
-    }
-
-    // 3. Delete stale entries
-    if (pathsToDelete.size() > 0) {
-        deleteStaleReplayCacheEntries(pathsToDelete);
-        // 4. Reload the table to reflect deletions
-        loadReplayCache();
-        QMessageBox::information(this, "Cleanup Complete", QString("Removed %1 entries from the database that no longer exist on disk.").arg(pathsToDelete.size()));
-    } else {
-        QMessageBox::information(this, "Cleanup Complete", "No stale entries found in the database.");
-    }
+    });
 }
 
 void MainWIndow::on_launchButton_clicked()
 {
-    int row = ui->replayTableWidget->currentRow();
-    if (row < 0) {
+    const QModelIndexList selectedRows = ui->replayTableView->selectionModel()->selectedRows();
+    if (selectedRows.isEmpty()) {
         QMessageBox::information(this, "Info", "No replay selected.");
         return;
     }
 
-    QTableWidgetItem* item = ui->replayTableWidget->item(row, 0);
-    if (!item) {
-        return;
-    }
-
-    QString replayPath = item->data(Qt::UserRole).toString();
+    QString replayPath = m_replayModel->pathAt(selectedRows.first().row());
 
 #ifdef Q_OS_WIN
     if (wot_executable_path.isEmpty()) {
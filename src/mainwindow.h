@@ -3,26 +3,22 @@
 
 #include <QMainWindow>
 #include <QSettings>
-#include <QTableWidget>
 #include <QFileSystemWatcher>
 #include <QThread>
 #include <QHash>
-#include <QtSql/QSqlDatabase>
-#include <QtSql/QSqlQuery>
 #include <QSet>
+#include <QLocale>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <memory>
+#include <functional>
 #include "replayscanner.h"
+#include "replaydatabase.h"
+#include "replaytablemodel.h"
 
 namespace Ui { class MainWIndow; }
 
-class DamageTableWidgetItem : public QTableWidgetItem {
-public:
-    bool operator <(const QTableWidgetItem &other) const override
-    {
-        // Compare the raw integer data stored in Qt::UserRole for accurate numerical sorting.
-        return data(Qt::UserRole).toInt() < other.data(Qt::UserRole).toInt();
-    }
-};
-
 class MainWIndow : public QMainWindow
 {
     Q_OBJECT
@@ -37,9 +33,17 @@ private slots:
     void on_settingsButton_clicked();
     void on_cleanupButton_clicked();
     void on_launchButton_clicked();
-    void on_replayTableWidget_itemSelectionChanged();
-    void onReplayScanFinished(const QList<ReplayInfo>& replays);
-    void onReplayScanProgress(const QString& currentFile);
+    void onReplaySelectionChanged();
+    void onReplaysParsed(const QList<ReplayInfo>& replays);
+    void onReplayScanFinished(const QSet<QString>& diskPaths);
+    void updateScanStatus();
+    void onDatabaseOpened(bool ok);
+    void onReplayCacheLoaded(const QList<ReplayInfo>& replays);
+    void onReplayPageLoaded(const ReplayQuery& query, const QList<ReplayInfo>& replays, int totalCount);
+    void onFilterTextChanged(const QString& text);
+    void onFilterApplied(int shownCount, int totalCount);
+    void onSearchFinished(quint64 requestId, bool ok, const QSet<QString>& matchingPaths);
+    void startFullTextSearch();
     void onReplayDirectoryChanged(const QString& path);
     void setupUiAndConnections();
 
@@ -52,13 +56,38 @@ private:
     QThread* m_workerThread;
     ReplayScanner* m_scanner;
 
+    // Scan progress is sampled by a timer instead of signalled per file
+    QTimer* m_progressTimer;
+    QElapsedTimer m_scanClock;
+    std::shared_ptr<const ScanProgress> m_scanProgress;
+
+    // All SQL runs on the database thread; the window only queues requests to it
+    QThread* m_databaseThread;
+    ReplayDatabase* m_database;
+    bool m_databaseReady = false;
+
+    // Filter bar words are looked up in the full-text index before the model filters
+    QTimer* m_searchTimer;
+    ReplayFilter m_searchFilter; // The parsed filter waiting for, or last answered by, a search
+    quint64 m_searchRequestId = 0;
+
     // Private methods for scan and table management
-    void startReplayScan(bool incremental = false, const QSet<QString>& knownPaths = {});
+    void startReplayScan(bool incremental = false, const QHash<QString, ReplayFingerprint>& knownReplays = {});
     void updateTable(const QList<ReplayInfo>& replays);
+    void mergeReplays(const QList<ReplayInfo>& replays);
+    void removeReplays(const QSet<QString>& paths);
+    void updateColumnWidths(bool allowShrink);
+    QString scrolledTopPath() const;
+    void restoreScrolledTop(const QString& topPath);
+    void showSnapshot();
+    void writeSnapshot();
+    QSet<QString> syncWithDisk(const QSet<QString>& diskPaths);
+    void removeStaleReplays(const QSet<QString>& paths);
+    void verifyCachedReplays(std::function<void(const QSet<QString>&)> onFinished = {});
 
     // Private methods for database management
-    bool initializeDatabase();
-    QSet<QString> loadReplayCache();
+    void initializeDatabase();
+    void loadReplayCache();
     void saveReplayCache(const QList<ReplayInfo>& replays);
     void deleteStaleReplayCacheEntries(const QSet<QString>& pathsToDelete);
 
@@ -68,8 +97,13 @@ private:
     QString replays_directory;
     QString bottle_name;
     QString client_version_xml_path;
-    QList<ReplayInfo> replaysData;
+    ReplayTableModel* m_replayModel; // The in-memory replay library behind the table view
+    QHash<QString, ReplayFingerprint> m_cacheIndex; // Every path stored in the database
     QString m_cacheFilePath;
+    QString m_snapshotFilePath;
+    QFuture<void> m_snapshotWrite;
+    int m_autoColumnWidths[ReplayTableModel::ColumnCount] = {}; // Widths last measured by updateColumnWidths
+    bool m_snapshotDirty = false; // The replay list changed while a snapshot write was running
 };
 
 #endif // MAINWINDOW_H
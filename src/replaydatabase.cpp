@@ -0,0 +1,804 @@
+#include "replaydatabase.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVariant>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+ReplayDatabase::ReplayDatabase(const QString& databasePath, QObject *parent)
+    : QObject(parent)
+    , m_databasePath(databasePath)
+    , m_connectionName(QString("replay_cache_%1").arg(reinterpret_cast<quintptr>(this), 0, 16))
+    , m_flushTimer(new QTimer(this))
+{
+    // Child of this object, so it follows it to the database thread
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(200);
+    connect(m_flushTimer, &QTimer::timeout, this, &ReplayDatabase::flush);
+}
+
+ReplayDatabase::~ReplayDatabase()
+{
+    close();
+}
+
+void ReplayDatabase::setWriteCoalesceInterval(int intervalMs)
+{
+    m_flushTimer->setInterval(intervalMs);
+}
+
+namespace {
+
+// Column order shared by every SELECT that is read back through readReplay
+const char* const kReplayColumns =
+    "path, playerName, tank, map, date, damage, server, version, fileSize, mtime, inode, battleTime";
+
+ReplayInfo readReplay(const QSqlQuery& query)
+{
+    ReplayInfo info;
+    // Map query result columns to ReplayInfo members
+    info.path = query.value(0).toString();
+    info.playerName = query.value(1).toString();
+    info.tank = query.value(2).toString();
+    info.map = query.value(3).toString();
+    info.date = query.value(4).toString();
+    info.damage = query.value(5).toInt(); // Ensure damage is read as an integer
+    info.server = query.value(6).toString();
+    info.version = query.value(7).toString();
+    info.fingerprint.size = query.value(8).toLongLong();
+    info.fingerprint.mtime = query.value(9).toLongLong();
+    info.fingerprint.inode = static_cast<quint64>(query.value(10).toLongLong());
+    info.battleTime = query.value(11).toLongLong();
+    return info;
+}
+
+// Whitelisted ORDER BY targets, indexed by ReplayQuery::SortColumn
+const char* const kSortColumns[] = {
+    "playerName", "tank", "map", "battleTime", "damage", "server", "version"
+};
+
+// Schema migrations, applied in order. Step N brings a cache from user_version N-1 to N.
+// Never edit a released step; append a new one instead.
+struct Migration {
+    const char* description;
+    QStringList statements;
+    // SQLite compile option the step depends on; without it the step is skipped but still counted
+    const char* requiredCompileOption = nullptr;
+};
+
+const QList<Migration>& migrations()
+{
+    static const QList<Migration> steps = {
+        { "create replays table", {
+            "CREATE TABLE IF NOT EXISTS replays ("
+            "path TEXT PRIMARY KEY, "
+            "playerName TEXT, "
+            "tank TEXT, "
+            "map TEXT, "
+            "date TEXT, "
+            "damage INTEGER, "
+            "server TEXT, "
+            "version TEXT)"
+        } },
+        // Rows from older caches keep NULL fingerprints, so the next incremental scan reparses them once
+        { "add file fingerprint columns", {
+            "ALTER TABLE replays ADD COLUMN fileSize INTEGER",
+            "ALTER TABLE replays ADD COLUMN mtime INTEGER",
+            "ALTER TABLE replays ADD COLUMN inode INTEGER"
+        } },
+        // The game writes dates as dd.MM.yyyy HH:mm:ss, which neither sorts nor range-filters as text
+        { "add battle time and lookup indexes", {
+            "ALTER TABLE replays ADD COLUMN battleTime INTEGER",
+            "UPDATE replays SET battleTime = COALESCE(CAST(strftime('%s', "
+            "substr(date, 7, 4) || '-' || substr(date, 4, 2) || '-' || substr(date, 1, 2) || ' ' || substr(date, 12, 8)"
+            ") AS INTEGER), 0)",
+            "CREATE INDEX IF NOT EXISTS idx_replays_battleTime ON replays (battleTime)",
+            "CREATE INDEX IF NOT EXISTS idx_replays_tank ON replays (tank)",
+            "CREATE INDEX IF NOT EXISTS idx_replays_map ON replays (map)",
+            "CREATE INDEX IF NOT EXISTS idx_replays_damage ON replays (damage)",
+            "CREATE INDEX IF NOT EXISTS idx_replays_server ON replays (server)"
+        } },
+        // External-content FTS5 index over the searchable text columns, kept in sync by triggers.
+        // Writes use UPSERT rather than INSERT OR REPLACE, because REPLACE's implicit delete fires no trigger.
+        { "add full-text search index", {
+            "CREATE VIRTUAL TABLE IF NOT EXISTS replays_fts USING fts5("
+            "playerName, tank, map, content='replays', content_rowid='rowid', "
+            "tokenize='unicode61 remove_diacritics 2', prefix='1 2 3')",
+            "CREATE TRIGGER IF NOT EXISTS replays_fts_insert AFTER INSERT ON replays BEGIN "
+            "INSERT INTO replays_fts (rowid, playerName, tank, map) VALUES (new.rowid, new.playerName, new.tank, new.map); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS replays_fts_delete AFTER DELETE ON replays BEGIN "
+            "INSERT INTO replays_fts (replays_fts, rowid, playerName, tank, map) VALUES ('delete', old.rowid, old.playerName, old.tank, old.map); "
+            "END",
+            "CREATE TRIGGER IF NOT EXISTS replays_fts_update AFTER UPDATE OF playerName, tank, map ON replays BEGIN "
+            "INSERT INTO replays_fts (replays_fts, rowid, playerName, tank, map) VALUES ('delete', old.rowid, old.playerName, old.tank, old.map); "
+            "INSERT INTO replays_fts (rowid, playerName, tank, map) VALUES (new.rowid, new.playerName, new.tank, new.map); "
+            "END",
+            "INSERT INTO replays_fts (replays_fts) VALUES ('rebuild')"
+        }, "ENABLE_FTS5" },
+        // Battle results, one battle row per replay. Children go with their battle through ON DELETE CASCADE.
+        // Clearing the fingerprints makes the next incremental scan reparse every replay once to fill them.
+        { "add normalized battle results", {
+            "CREATE TABLE IF NOT EXISTS battle ("
+            "id INTEGER PRIMARY KEY, "
+            "path TEXT NOT NULL UNIQUE, "
+            "arenaUniqueId TEXT, "
+            "arenaTypeId INTEGER, "
+            "winnerTeam INTEGER, "
+            "finishReason INTEGER, "
+            "duration INTEGER)",
+            "CREATE TABLE IF NOT EXISTS personal_result ("
+            "battleId INTEGER PRIMARY KEY REFERENCES battle (id) ON DELETE CASCADE, "
+            "team INTEGER, "
+            "outcome INTEGER, "
+            "xp INTEGER, "
+            "credits INTEGER, "
+            "kills INTEGER, "
+            "damageDealt INTEGER, "
+            "damageAssistedRadio INTEGER, "
+            "damageAssistedTrack INTEGER, "
+            "spotted INTEGER, "
+            "damageReceived INTEGER, "
+            "shots INTEGER, "
+            "directHits INTEGER, "
+            "piercings INTEGER, "
+            "lifeTime INTEGER)",
+            "CREATE TABLE IF NOT EXISTS participant ("
+            "battleId INTEGER NOT NULL REFERENCES battle (id) ON DELETE CASCADE, "
+            "vehicleId INTEGER NOT NULL, "
+            "accountDbId INTEGER, "
+            "name TEXT, "
+            "clan TEXT, "
+            "team INTEGER, "
+            "vehicle TEXT, "
+            "damageDealt INTEGER, "
+            "kills INTEGER, "
+            "xp INTEGER, "
+            "spotted INTEGER, "
+            "damageAssisted INTEGER, "
+            "survived INTEGER, "
+            "PRIMARY KEY (battleId, vehicleId)) WITHOUT ROWID",
+            "CREATE INDEX IF NOT EXISTS idx_battle_arenaUniqueId ON battle (arenaUniqueId)",
+            "CREATE INDEX IF NOT EXISTS idx_participant_accountDbId ON participant (accountDbId)",
+            "CREATE INDEX IF NOT EXISTS idx_participant_vehicle ON participant (vehicle)",
+            "UPDATE replays SET fileSize = NULL, mtime = NULL, inode = NULL"
+        } },
+        // Filtering and sorting happen in the model, so only the first-page battleTime order reads an index.
+        // The others cost a b-tree update on every upsert for nothing.
+        { "drop unused lookup indexes", {
+            "DROP INDEX IF EXISTS idx_replays_tank",
+            "DROP INDEX IF EXISTS idx_replays_map",
+            "DROP INDEX IF EXISTS idx_replays_damage",
+            "DROP INDEX IF EXISTS idx_replays_server"
+        } },
+    };
+    return steps;
+}
+
+} // namespace
+
+/**
+ * @brief Opens this thread's connection to the cache, tunes it and migrates the schema.
+ * Must run on the database thread, since a connection may only be used by the thread that created it.
+ */
+void ReplayDatabase::open()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    db.setDatabaseName(m_databasePath);
+
+    if (!db.open()) {
+        qCritical() << "Error: Failed to connect to database:" << db.lastError().text();
+        emit opened(false);
+        return;
+    }
+
+    configureConnection();
+    emit opened(migrateSchema());
+}
+
+/**
+ * @brief Applies per-connection pragmas. Failures are logged but not fatal; SQLite just keeps its defaults.
+ */
+void ReplayDatabase::configureConnection()
+{
+    // WAL lets reads proceed while a scan batch commits, and NORMAL sync is still crash-safe in WAL mode
+    const QStringList pragmas = {
+        "PRAGMA journal_mode = WAL",
+        "PRAGMA foreign_keys = ON",     // Battle result children are removed with their battle
+        "PRAGMA synchronous = NORMAL",
+        "PRAGMA temp_store = MEMORY",
+        "PRAGMA cache_size = -16384",   // 16 MiB page cache
+        "PRAGMA mmap_size = 268435456", // Map up to 256 MiB of the file instead of read() calls
+    };
+
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << "Failed to apply" << pragma << ":" << query.lastError().text();
+        }
+    }
+}
+
+/**
+ * @brief Brings the cache schema up to date, using PRAGMA user_version as the schema version.
+ * Each step runs in its own transaction together with its version bump.
+ */
+bool ReplayDatabase::migrateSchema()
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    QSqlQuery query(db);
+
+    int version = 0;
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        version = query.value(0).toInt();
+    }
+    query.finish();
+
+    const QList<Migration>& steps = migrations();
+    if (version > steps.size()) {
+        qCritical() << "Replay cache schema version" << version << "is newer than this build supports:" << steps.size();
+        return false;
+    }
+
+    // Caches written before versioning existed report user_version 0 but may already have some columns
+    QSet<QString> existingColumns;
+    if (version == 0 && query.exec("PRAGMA table_info(replays)")) {
+        while (query.next()) {
+            existingColumns.insert(query.value(1).toString());
+        }
+        query.finish();
+    }
+
+    for (int step = version; step < steps.size(); ++step) {
+        const Migration& migration = steps[step];
+        if (!db.transaction()) {
+            qCritical() << "Failed to start migration transaction:" << db.lastError().text();
+            return false;
+        }
+
+        bool supported = true;
+        if (migration.requiredCompileOption) {
+            query.prepare("SELECT sqlite_compileoption_used(?)");
+            query.bindValue(0, QString::fromLatin1(migration.requiredCompileOption));
+            supported = query.exec() && query.next() && query.value(0).toBool();
+            query.finish();
+            if (!supported) {
+                qWarning() << "Skipping replay cache migration" << step + 1 << "(" << migration.description
+                           << "): SQLite was built without" << migration.requiredCompileOption;
+            }
+        }
+
+        for (const QString& statement : supported ? migration.statements : QStringList()) {
+            if (statement.startsWith("ALTER TABLE replays ADD COLUMN ")
+                && existingColumns.contains(statement.section(' ', 5, 5))) {
+                continue;
+            }
+            if (!query.exec(statement)) {
+                qCritical() << "Replay cache migration" << step + 1 << "(" << migration.description << ") failed:" << query.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+
+        if (!query.exec(QString("PRAGMA user_version = %1").arg(step + 1)) || !db.commit()) {
+            qCritical() << "Failed to record replay cache schema version" << step + 1 << ":" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        qDebug() << "Migrated replay cache to schema version" << step + 1 << "-" << migration.description;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads every cached replay and delivers them through replaysLoaded.
+ * Pending writes are committed first so the result reflects everything requested so far.
+ */
+void ReplayDatabase::loadReplays()
+{
+    flush();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<ReplayInfo> replays;
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+    query.setForwardOnly(true);
+
+    if (!query.exec(QString("SELECT %1 FROM replays").arg(kReplayColumns))) {
+        qCritical() << "Error selecting replays:" << query.lastError().text();
+        emit replaysLoaded(replays);
+        return;
+    }
+
+    while (query.next()) {
+        replays.append(readReplay(query));
+    }
+
+    logThroughput("Loaded", replays.size(), timer.nsecsElapsed());
+    emit replaysLoaded(replays);
+}
+
+/**
+ * @brief Selects the first `limit` replays in the requested order and delivers them through
+ * replayPageLoaded, together with the total replay count. In date order the battleTime index
+ * serves the ORDER BY, so only the requested rows are read.
+ */
+void ReplayDatabase::queryReplays(const ReplayQuery& request)
+{
+    flush();
+
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+    query.setForwardOnly(true);
+
+    int totalCount = 0;
+    if (query.exec("SELECT COUNT(*) FROM replays") && query.next()) {
+        totalCount = query.value(0).toInt();
+    } else {
+        qCritical() << "Error counting replays:" << query.lastError().text();
+    }
+
+    // path breaks ties between equal keys
+    const QString order = request.sortOrder == Qt::AscendingOrder ? "ASC" : "DESC";
+    query.prepare(QString("SELECT %1 FROM replays ORDER BY %2 %3, path %3 LIMIT ?")
+                      .arg(kReplayColumns, kSortColumns[request.sortColumn], order));
+    query.bindValue(0, request.limit);
+
+    QList<ReplayInfo> replays;
+    if (!query.exec()) {
+        qCritical() << "Error selecting replay page:" << query.lastError().text();
+    } else {
+        while (query.next()) {
+            replays.append(readReplay(query));
+        }
+    }
+
+    emit replayPageLoaded(request, replays, totalCount);
+}
+
+/**
+ * @brief Finds the paths of all replays whose player, tank or map match the search text.
+ * Answers through searchFinished with the caller's requestId, so stale answers can be dropped.
+ * ok is false if the full-text index could not be queried, e.g. on SQLite without FTS5.
+ */
+void ReplayDatabase::searchReplays(const QString& text, quint64 requestId)
+{
+    flush();
+
+    QSet<QString> matchingPaths;
+    const QString match = ftsMatchExpression(text);
+    if (match.isEmpty()) {
+        emit searchFinished(requestId, true, matchingPaths);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+    query.setForwardOnly(true);
+    query.prepare("SELECT replays.path FROM replays_fts JOIN replays ON replays.rowid = replays_fts.rowid "
+                  "WHERE replays_fts MATCH ?");
+    query.bindValue(0, match);
+    if (!query.exec()) {
+        qWarning() << "Error searching replays:" << query.lastError().text();
+        emit searchFinished(requestId, false, matchingPaths);
+        return;
+    }
+    while (query.next()) {
+        matchingPaths.insert(query.value(0).toString());
+    }
+
+    logThroughput("Matched", matchingPaths.size(), timer.nsecsElapsed());
+    emit searchFinished(requestId, true, matchingPaths);
+}
+
+/**
+ * @brief Turns free search text into an FTS5 query: every whitespace-separated term becomes a
+ * quoted prefix phrase, so punctuation in names like "Obj." or "T-34" is matched literally
+ * instead of being parsed as query syntax. Terms are ANDed.
+ */
+QString ReplayDatabase::ftsMatchExpression(const QString& text)
+{
+    QStringList terms;
+    const QStringList words = text.simplified().split(QChar(' '), Qt::SkipEmptyParts);
+    for (QString word : words) {
+        word.replace(QChar('"'), QStringLiteral("\"\""));
+        terms << QChar('"') + word + QStringLiteral("\"*");
+    }
+    return terms.join(' ');
+}
+
+/**
+ * @brief Queues new or updated replays to be inserted (or replaced) on the next flush.
+ */
+void ReplayDatabase::saveReplays(const QList<ReplayInfo>& replays)
+{
+    for (const ReplayInfo& info : replays) {
+        m_pendingDeletes.remove(info.path);
+        m_pendingSaves.insert(info.path, info);
+    }
+    scheduleFlush();
+}
+
+/**
+ * @brief Queues end-of-battle results; a replay's previous results are replaced on the next flush,
+ * or just deleted if the replay came without results.
+ */
+void ReplayDatabase::saveBattleResults(const QList<BattleResults>& results)
+{
+    for (const BattleResults& battle : results) {
+        m_pendingBattles.insert(battle.path, battle);
+    }
+    scheduleFlush();
+}
+
+/**
+ * @brief Queues replays whose files no longer exist on disk to be deleted on the next flush.
+ */
+void ReplayDatabase::deleteReplays(const QSet<QString>& paths)
+{
+    for (const QString& path : paths) {
+        m_pendingSaves.remove(path);
+        m_pendingBattles.remove(path);
+        m_pendingDeletes.insert(path);
+    }
+    scheduleFlush();
+}
+
+void ReplayDatabase::scheduleFlush()
+{
+    // Keep the running timer so a steady stream of batches still commits at a fixed cadence
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+/**
+ * @brief Commits all pending saves, battle results and deletes in one transaction.
+ */
+void ReplayDatabase::flush()
+{
+    m_flushTimer->stop();
+    if (m_pendingSaves.isEmpty() && m_pendingDeletes.isEmpty() && m_pendingBattles.isEmpty()) {
+        return;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    if (!db.isOpen()) {
+        qWarning() << "Database not open for saving.";
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Start transaction for speed and atomicity
+    if (!db.transaction()) {
+        qCritical() << "Failed to start transaction:" << db.lastError().text();
+        return;
+    }
+
+    QSqlQuery query(db);
+    if (!m_pendingSaves.isEmpty() && !writePendingSaves(db)) {
+        db.rollback();
+        return;
+    }
+
+    qint64 battleRows = 0;
+    if (!m_pendingBattles.isEmpty() && !writePendingBattles(db, battleRows)) {
+        db.rollback();
+        return;
+    }
+
+    if (!m_pendingDeletes.isEmpty() && !deletePendingPaths(query)) {
+        db.rollback();
+        return;
+    }
+
+    if (!db.commit()) {
+        qCritical() << "Failed to commit transaction:" << db.lastError().text();
+        db.rollback();
+        return;
+    }
+
+    const int savedCount = int(m_pendingSaves.size());
+    const int deletedCount = int(m_pendingDeletes.size());
+    m_pendingSaves.clear();
+    m_pendingDeletes.clear();
+    m_pendingBattles.clear();
+
+    logThroughput("Committed", savedCount + deletedCount + battleRows, timer.nsecsElapsed());
+    emit writesCommitted(savedCount, deletedCount);
+}
+
+/**
+ * @brief Deletes all pending stale paths with one set-based statement.
+ * The paths are bulk-loaded into a temp table through a single prepared insert and then removed
+ * with DELETE ... IN (SELECT ...), so the statement stays the same size no matter how many
+ * paths there are and paths need no quoting. Runs inside the caller's transaction.
+ */
+bool ReplayDatabase::deletePendingPaths(QSqlQuery& query)
+{
+    // temp_store is MEMORY, so the staging table never touches disk; it lives as long as the connection
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS stale_paths (path TEXT PRIMARY KEY)")
+        || !query.exec("DELETE FROM stale_paths")) {
+        qCritical() << "Error preparing stale path table:" << query.lastError().text();
+        return false;
+    }
+
+    if (!query.prepare("INSERT OR IGNORE INTO stale_paths (path) VALUES (?)")) {
+        qCritical() << "Error preparing stale path insert:" << query.lastError().text();
+        return false;
+    }
+    for (const QString& path : std::as_const(m_pendingDeletes)) {
+        query.bindValue(0, path);
+        if (!query.exec()) {
+            qCritical() << "Error staging stale path:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    if (!query.exec("DELETE FROM battle WHERE path IN (SELECT path FROM stale_paths)")) {
+        qCritical() << "Error deleting battle results of stale entries:" << query.lastError().text();
+        return false;
+    }
+    if (!query.exec("DELETE FROM replays WHERE path IN (SELECT path FROM stale_paths)")) {
+        qCritical() << "Error executing delete query for stale entries:" << query.lastError().text();
+        return false;
+    }
+
+    // Leave the staging table empty so its pages are reused by the next flush
+    query.exec("DELETE FROM stale_paths");
+    return true;
+}
+
+/**
+ * @brief Upserts all pending replays with multi-row INSERT statements.
+ * Rows go in chunks of kRowsPerStatement, so SQLite parses and steps one statement per chunk
+ * instead of one per replay. The full-chunk statement is prepared once and re-bound for every
+ * chunk; only the final partial chunk needs its own statement. Runs inside the caller's transaction.
+ */
+bool ReplayDatabase::writePendingSaves(QSqlDatabase& db)
+{
+    // 64 rows x 12 columns stays below the 999 host parameters older SQLite builds allow
+    constexpr int kRowsPerStatement = 64;
+    constexpr int kColumns = 12;
+
+    auto statement = [](int rows) {
+        QString values = "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        values.reserve(rows * (values.size() + 2));
+        for (int row = 1; row < rows; ++row) {
+            values += ", (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        }
+        // Upsert: if a replay with the same path (PRIMARY KEY) exists, it is updated in place,
+        // which keeps its rowid and fires the full-text index's update trigger.
+        return "INSERT INTO replays (path, playerName, tank, map, date, damage, server, version, fileSize, mtime, inode, battleTime) "
+               "VALUES " + values + " "
+               "ON CONFLICT (path) DO UPDATE SET playerName = excluded.playerName, tank = excluded.tank, "
+               "map = excluded.map, date = excluded.date, damage = excluded.damage, server = excluded.server, "
+               "version = excluded.version, fileSize = excluded.fileSize, mtime = excluded.mtime, "
+               "inode = excluded.inode, battleTime = excluded.battleTime";
+    };
+
+    const QList<ReplayInfo> replays = m_pendingSaves.values();
+    QSqlQuery fullChunk(db);
+    bool fullChunkPrepared = false;
+
+    for (qsizetype first = 0; first < replays.size(); first += kRowsPerStatement) {
+        const int rows = int(qMin<qsizetype>(kRowsPerStatement, replays.size() - first));
+
+        QSqlQuery partialChunk(db);
+        QSqlQuery& query = rows == kRowsPerStatement ? fullChunk : partialChunk;
+        if (rows < kRowsPerStatement || !fullChunkPrepared) {
+            if (!query.prepare(statement(rows))) {
+                qCritical() << "Error preparing replay insert:" << query.lastError().text();
+                return false;
+            }
+            fullChunkPrepared = fullChunkPrepared || rows == kRowsPerStatement;
+        }
+
+        for (int row = 0; row < rows; ++row) {
+            const ReplayInfo& info = replays.at(first + row);
+            const int base = row * kColumns;
+            query.bindValue(base + 0, info.path);
+            query.bindValue(base + 1, info.playerName);
+            query.bindValue(base + 2, info.tank);
+            query.bindValue(base + 3, info.map);
+            query.bindValue(base + 4, info.date);
+            query.bindValue(base + 5, info.damage);
+            query.bindValue(base + 6, info.server);
+            query.bindValue(base + 7, info.version);
+            query.bindValue(base + 8, info.fingerprint.size);
+            query.bindValue(base + 9, info.fingerprint.mtime);
+            query.bindValue(base + 10, static_cast<qint64>(info.fingerprint.inode));
+            query.bindValue(base + 11, info.battleTime);
+        }
+        if (!query.exec()) {
+            qCritical() << "Error inserting/replacing replays:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Replaces the battle, personal_result and participant rows of every pending battle.
+ * Battles without results only have their old rows deleted.
+ * Battle and personal rows go one at a time, since each child row needs its battle's id.
+ * Participant rows, about thirty per battle, are collected across battles and written in
+ * chunks of kRowsPerStatement the way writePendingSaves writes replays. Runs inside the
+ * caller's transaction; `rowsWritten` receives the number of rows inserted.
+ */
+bool ReplayDatabase::writePendingBattles(QSqlDatabase& db, qint64& rowsWritten)
+{
+    // 64 rows x 13 columns stays below the 999 host parameters older SQLite builds allow
+    constexpr int kRowsPerStatement = 64;
+    constexpr int kParticipantColumns = 13;
+
+    QSqlQuery deleteBattle(db);
+    QSqlQuery insertBattle(db);
+    QSqlQuery insertPersonal(db);
+
+    auto prepare = [](QSqlQuery& query, const QString& statement) {
+        if (!query.prepare(statement)) {
+            qCritical() << "Error preparing battle result statement:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    };
+
+    // The old battle row takes its personal and participant rows with it
+    if (!prepare(deleteBattle, "DELETE FROM battle WHERE path = ?")
+        || !prepare(insertBattle,
+            "INSERT INTO battle (path, arenaUniqueId, arenaTypeId, winnerTeam, finishReason, duration) "
+            "VALUES (?, ?, ?, ?, ?, ?)")
+        || !prepare(insertPersonal,
+            "INSERT INTO personal_result (battleId, team, outcome, xp, credits, kills, damageDealt, "
+            "damageAssistedRadio, damageAssistedTrack, spotted, damageReceived, shots, directHits, piercings, lifeTime) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)")) {
+        return false;
+    }
+
+    auto participantStatement = [](int rows) {
+        QString values = "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        values.reserve(rows * (values.size() + 2));
+        for (int row = 1; row < rows; ++row) {
+            values += ", (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        }
+        return "INSERT OR REPLACE INTO participant (battleId, vehicleId, accountDbId, name, clan, team, vehicle, "
+               "damageDealt, kills, xp, spotted, damageAssisted, survived) VALUES " + values;
+    };
+
+    struct ParticipantRow {
+        qint64 battleId;
+        const BattleParticipant* participant;
+    };
+    QList<ParticipantRow> participantRows;
+    participantRows.reserve(kRowsPerStatement);
+    QSqlQuery fullChunk(db);
+    bool fullChunkPrepared = false;
+
+    // Writes the collected participant rows as one statement
+    auto writeParticipants = [&]() {
+        const int rows = int(participantRows.size());
+        QSqlQuery partialChunk(db);
+        QSqlQuery& query = rows == kRowsPerStatement ? fullChunk : partialChunk;
+        if (rows < kRowsPerStatement || !fullChunkPrepared) {
+            if (!prepare(query, participantStatement(rows))) {
+                return false;
+            }
+            fullChunkPrepared = fullChunkPrepared || rows == kRowsPerStatement;
+        }
+
+        for (int row = 0; row < rows; ++row) {
+            const BattleParticipant& participant = *participantRows.at(row).participant;
+            const int base = row * kParticipantColumns;
+            query.bindValue(base + 0, participantRows.at(row).battleId);
+            query.bindValue(base + 1, participant.vehicleId);
+            query.bindValue(base + 2, participant.accountDbId);
+            query.bindValue(base + 3, participant.name);
+            query.bindValue(base + 4, participant.clan);
+            query.bindValue(base + 5, participant.team);
+            query.bindValue(base + 6, participant.vehicle);
+            query.bindValue(base + 7, participant.damageDealt);
+            query.bindValue(base + 8, participant.kills);
+            query.bindValue(base + 9, participant.xp);
+            query.bindValue(base + 10, participant.spotted);
+            query.bindValue(base + 11, participant.damageAssisted);
+            query.bindValue(base + 12, participant.survived);
+        }
+        if (!query.exec()) {
+            qCritical() << "Error writing participants:" << query.lastError().text();
+            return false;
+        }
+        rowsWritten += rows;
+        participantRows.clear();
+        return true;
+    };
+
+    for (const BattleResults& battle : std::as_const(m_pendingBattles)) {
+        deleteBattle.bindValue(0, battle.path);
+        if (!battle.present) {
+            if (!deleteBattle.exec()) {
+                qCritical() << "Error deleting battle results:" << deleteBattle.lastError().text();
+                return false;
+            }
+            continue;
+        }
+        insertBattle.bindValue(0, battle.path);
+        insertBattle.bindValue(1, battle.arenaUniqueId);
+        insertBattle.bindValue(2, battle.arenaTypeId);
+        insertBattle.bindValue(3, battle.winnerTeam);
+        insertBattle.bindValue(4, battle.finishReason);
+        insertBattle.bindValue(5, battle.duration);
+        if (!deleteBattle.exec() || !insertBattle.exec()) {
+            qCritical() << "Error writing battle results:" << deleteBattle.lastError().text() << insertBattle.lastError().text();
+            return false;
+        }
+        const qint64 battleId = insertBattle.lastInsertId().toLongLong();
+        ++rowsWritten;
+
+        if (battle.personal.present) {
+            const PersonalResult& own = battle.personal;
+            insertPersonal.bindValue(0, battleId);
+            insertPersonal.bindValue(1, own.team);
+            insertPersonal.bindValue(2, own.outcome);
+            insertPersonal.bindValue(3, own.xp);
+            insertPersonal.bindValue(4, own.credits);
+            insertPersonal.bindValue(5, own.kills);
+            insertPersonal.bindValue(6, own.damageDealt);
+            insertPersonal.bindValue(7, own.damageAssistedRadio);
+            insertPersonal.bindValue(8, own.damageAssistedTrack);
+            insertPersonal.bindValue(9, own.spotted);
+            insertPersonal.bindValue(10, own.damageReceived);
+            insertPersonal.bindValue(11, own.shots);
+            insertPersonal.bindValue(12, own.directHits);
+            insertPersonal.bindValue(13, own.piercings);
+            insertPersonal.bindValue(14, own.lifeTime);
+            if (!insertPersonal.exec()) {
+                qCritical() << "Error writing personal result:" << insertPersonal.lastError().text();
+                return false;
+            }
+            ++rowsWritten;
+        }
+
+        for (const BattleParticipant& participant : battle.participants) {
+            participantRows.append({ battleId, &participant });
+            if (participantRows.size() == kRowsPerStatement && !writeParticipants()) {
+                return false;
+            }
+        }
+    }
+    return participantRows.isEmpty() || writeParticipants();
+}
+
+/**
+ * @brief Logs row throughput of a cache operation, so pragma or schema changes can be compared from the debug log.
+ */
+void ReplayDatabase::logThroughput(const char* operation, qint64 rows, qint64 elapsedNs)
+{
+    const double seconds = elapsedNs / 1e9;
+    qDebug().nospace() << "Replay cache: " << operation << " " << rows << " rows in "
+                       << elapsedNs / 1000000 << " ms (" << qint64(seconds > 0 ? rows / seconds : 0) << " rows/s)";
+}
+
+/**
+ * @brief Commits pending writes and closes this thread's connection.
+ */
+void ReplayDatabase::close()
+{
+    if (!QSqlDatabase::contains(m_connectionName)) {
+        return;
+    }
+
+    flush();
+    {
+        QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
@@ -0,0 +1,81 @@
+#ifndef REPLAYDATABASE_H
+#define REPLAYDATABASE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QString>
+#include "replayscanner.h"
+
+class QTimer;
+class QSqlQuery;
+class QSqlDatabase;
+
+// The first page of the replay library, ordered by SQLite. Used to fill the table before the
+// full cache has been loaded; filtering happens in the in-memory model, not here. Only date
+// order has an index; other columns sort the whole table.
+struct ReplayQuery {
+    enum SortColumn { SortByPlayer, SortByTank, SortByMap, SortByDate, SortByDamage, SortByServer, SortByVersion };
+
+    SortColumn sortColumn = SortByDate;
+    Qt::SortOrder sortOrder = Qt::DescendingOrder;
+    int limit = 200;
+};
+
+// SQLite replay cache service. The object is moved to a dedicated thread and owns its own
+// named connection there, so no SQL ever runs on the GUI thread. Requests are made through
+// queued slot calls and answered through signals.
+//
+// Writes are not executed one call at a time: saveReplays and deleteReplays only queue the
+// change, and everything queued within the coalescing interval is committed in a single
+// transaction. flush() forces the pending writes out immediately.
+class ReplayDatabase : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ReplayDatabase(const QString& databasePath, QObject *parent = nullptr);
+    ~ReplayDatabase();
+
+    // Delay between the first queued write and the transaction that commits it.
+    void setWriteCoalesceInterval(int intervalMs);
+
+public slots:
+    void open();
+    void loadReplays();
+    void queryReplays(const ReplayQuery& query);
+    void searchReplays(const QString& text, quint64 requestId);
+    void saveReplays(const QList<ReplayInfo>& replays);
+    void saveBattleResults(const QList<BattleResults>& results);
+    void deleteReplays(const QSet<QString>& paths);
+    void flush();
+    void close();
+
+signals:
+    void opened(bool ok);
+    void replaysLoaded(const QList<ReplayInfo>& replays);
+    void replayPageLoaded(const ReplayQuery& query, const QList<ReplayInfo>& replays, int totalCount);
+    void searchFinished(quint64 requestId, bool ok, const QSet<QString>& matchingPaths);
+    void writesCommitted(int savedCount, int deletedCount);
+
+private:
+    static QString ftsMatchExpression(const QString& text);
+    void configureConnection();
+    bool migrateSchema();
+    bool deletePendingPaths(QSqlQuery& query);
+    bool writePendingSaves(QSqlDatabase& db);
+    bool writePendingBattles(QSqlDatabase& db, qint64& rowsWritten);
+    static void logThroughput(const char* operation, qint64 rows, qint64 elapsedNs);
+    void scheduleFlush();
+
+    QString m_databasePath;
+    QString m_connectionName;
+    QTimer* m_flushTimer;
+
+    // Pending writes keyed by path; a later save or delete of the same path replaces the earlier one
+    QHash<QString, ReplayInfo> m_pendingSaves;
+    QSet<QString> m_pendingDeletes;
+    QHash<QString, BattleResults> m_pendingBattles;
+};
+
+#endif // REPLAYDATABASE_H
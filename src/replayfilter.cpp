@@ -0,0 +1,195 @@
+#include "replayfilter.h"
+#include <QDate>
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTimeZone>
+
+namespace {
+
+// Tightens a lower bound, setting it if there is none yet
+template<typename T>
+void raiseMin(std::optional<T>& bound, T value)
+{
+    bound = bound ? qMax(*bound, value) : value;
+}
+
+// Tightens an upper bound, setting it if there is none yet
+template<typename T>
+void lowerMax(std::optional<T>& bound, T value)
+{
+    bound = bound ? qMin(*bound, value) : value;
+}
+
+// Start of a day in battle time, which is stored as UTC like ReplayScanner::battleTimeFromDate
+qint64 dayStart(const QDate& day)
+{
+    return QDateTime(day, QTime(0, 0), QTimeZone::utc()).toSecsSinceEpoch();
+}
+
+QDate parseDay(const QString& text)
+{
+    QDate day = QDate::fromString(text, "dd.MM.yyyy");
+    if (!day.isValid()) {
+        day = QDate::fromString(text, Qt::ISODate);
+    }
+    return day;
+}
+
+bool applyDamage(ReplayFilter& filter, const QString& op, const QString& value)
+{
+    bool ok = false;
+    const int damage = value.toInt(&ok);
+    if (!ok || damage < 0) {
+        return false;
+    }
+
+    if (op == ":") {
+        raiseMin(filter.minDamage, damage);
+        lowerMax(filter.maxDamage, damage);
+    } else if (op == ">=") {
+        raiseMin(filter.minDamage, damage);
+    } else if (op == ">") {
+        raiseMin(filter.minDamage, damage + 1);
+    } else if (op == "<=") {
+        lowerMax(filter.maxDamage, damage);
+    } else {
+        lowerMax(filter.maxDamage, damage - 1);
+    }
+    return true;
+}
+
+bool applyDate(ReplayFilter& filter, const QString& op, const QString& value)
+{
+    const QDate day = parseDay(value);
+    if (!day.isValid()) {
+        return false;
+    }
+
+    const qint64 start = dayStart(day);
+    const qint64 end = dayStart(day.addDays(1)) - 1;
+    if (op == ":") {
+        raiseMin(filter.fromBattleTime, start);
+        lowerMax(filter.toBattleTime, end);
+    } else if (op == ">=") {
+        raiseMin(filter.fromBattleTime, start);
+    } else if (op == ">") {
+        raiseMin(filter.fromBattleTime, end + 1);
+    } else if (op == "<=") {
+        lowerMax(filter.toBattleTime, end);
+    } else {
+        lowerMax(filter.toBattleTime, start - 1);
+    }
+    return true;
+}
+
+// An unset previous bound is implied by anything; a set one only by an equal or tighter one
+template<typename T>
+bool minImplies(const std::optional<T>& bound, const std::optional<T>& previous)
+{
+    return !previous || (bound && *bound >= *previous);
+}
+
+template<typename T>
+bool maxImplies(const std::optional<T>& bound, const std::optional<T>& previous)
+{
+    return !previous || (bound && *bound <= *previous);
+}
+
+} // namespace
+
+/**
+ * @brief Parses the filter bar text. Tokens that are not valid criteria are searched as text.
+ */
+ReplayFilter ReplayFilter::parse(const QString& text)
+{
+    static const QRegularExpression criterion("^([a-z]+)(:|>=|<=|>|<)(.+)$",
+                                              QRegularExpression::CaseInsensitiveOption);
+
+    ReplayFilter filter;
+    const QStringList tokens = text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    for (const QString& token : tokens) {
+        const QRegularExpressionMatch match = criterion.match(token);
+        if (match.hasMatch()) {
+            const QString key = match.captured(1).toLower();
+            const QString op = match.captured(2);
+            const QString value = match.captured(3);
+
+            if (key == "damage" && applyDamage(filter, op, value)) {
+                continue;
+            }
+            if (key == "date" && applyDate(filter, op, value)) {
+                continue;
+            }
+            if (op == ":") {
+                Field field = AnyField;
+                if (key == "player") field = PlayerField;
+                else if (key == "tank") field = TankField;
+                else if (key == "map") field = MapField;
+                else if (key == "server") field = ServerField;
+                else if (key == "version") field = VersionField;
+                if (field != AnyField) {
+                    filter.terms.append({ field, value });
+                    continue;
+                }
+            }
+        }
+        filter.terms.append({ AnyField, token });
+    }
+    return filter;
+}
+
+QString ReplayFilter::fullTextQuery() const
+{
+    QStringList words;
+    for (const Term& term : terms) {
+        if (term.field == AnyField) {
+            words << term.text;
+        }
+    }
+    return words.join(' ');
+}
+
+bool ReplayFilter::isEmpty() const
+{
+    return terms.isEmpty() && !minDamage && !maxDamage && !fromBattleTime && !toBattleTime;
+}
+
+/**
+ * @brief Checks whether this filter is at least as strict as previous. Typing more characters
+ * into a word, adding a word or tightening a bound all narrow the filter.
+ */
+bool ReplayFilter::narrows(const ReplayFilter& previous) const
+{
+    // Index matches follow word prefixes, not substrings, so the rules below do not hold for them
+    if (fullTextMatches || previous.fullTextMatches) {
+        return false;
+    }
+
+    for (const Term& old : previous.terms) {
+        bool implied = false;
+        for (const Term& term : terms) {
+            // A word restricted to player, tank or map still implies the same word in any of them
+            const bool sameScope = term.field == old.field
+                || (old.field == AnyField && (term.field == PlayerField || term.field == TankField || term.field == MapField));
+            if (sameScope && term.text.contains(old.text, Qt::CaseInsensitive)) {
+                implied = true;
+                break;
+            }
+        }
+        if (!implied) {
+            return false;
+        }
+    }
+
+    return minImplies(minDamage, previous.minDamage) && maxImplies(maxDamage, previous.maxDamage)
+        && minImplies(fromBattleTime, previous.fromBattleTime) && maxImplies(toBattleTime, previous.toBattleTime);
+}
+
+bool ReplayFilter::matchesBounds(int damage, qint64 battleTime) const
+{
+    return (!minDamage || damage >= *minDamage)
+        && (!maxDamage || damage <= *maxDamage)
+        && (!fromBattleTime || battleTime >= *fromBattleTime)
+        && (!toBattleTime || battleTime <= *toBattleTime);
+}
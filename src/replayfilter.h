@@ -0,0 +1,47 @@
+#ifndef REPLAYFILTER_H
+#define REPLAYFILTER_H
+
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <optional>
+
+// Criteria typed into the filter bar. Plain words must each appear in the player, tank or map
+// name; "player:", "tank:", "map:", "server:" and "version:" restrict a word to one column;
+// "damage" and "date" take a comparison, as in "damage>=3000" or "date<01.06.2025".
+// Unset bounds are ignored; bounds are inclusive.
+//
+// Plain words are answered by the cache's full-text index where possible: the window runs
+// fullTextQuery() through ReplayDatabase::searchReplays and stores the matching paths in
+// fullTextMatches, so each word matches names containing a word that starts with it ("obj"
+// finds "Obj. 140", "T-34" finds "T-34-85"). Without that answer, plain words fall back to
+// case-insensitive substrings, like the column-restricted words always are.
+struct ReplayFilter {
+    enum Field { AnyField, PlayerField, TankField, MapField, ServerField, VersionField };
+
+    struct Term {
+        Field field = AnyField;
+        QString text;
+    };
+
+    QList<Term> terms;
+    std::optional<int> minDamage;
+    std::optional<int> maxDamage;
+    std::optional<qint64> fromBattleTime;
+    std::optional<qint64> toBattleTime;
+
+    // Paths the full-text index matched for all plain words together; unset if not searched
+    std::optional<QSet<QString>> fullTextMatches;
+
+    static ReplayFilter parse(const QString& text);
+    // The plain words, space-separated, as the full-text search text
+    QString fullTextQuery() const;
+
+    bool isEmpty() const;
+    // True if every replay matching this filter also matches previous, so this filter
+    // only needs to be evaluated over the previous result.
+    bool narrows(const ReplayFilter& previous) const;
+    bool matchesBounds(int damage, qint64 battleTime) const;
+};
+
+#endif // REPLAYFILTER_H
@@ -1,18 +1,28 @@
 #include "replayscanner.h"
+#include "wotparser.h"
+#include "tankmapping.h"
 #include <QDebug>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QElapsedTimer>
 #include <QFile>
-#include <QJsonParseError>
+#include <QFileInfo>
 #include <QThread>
+#include <vector>
 
-extern "C" {
-const char* parse_replay(const char* path_to_replay_file);
-void free_string(char* s);
-}
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 ReplayScanner::ReplayScanner(const QString& replaysDir, QObject *parent)
-    : QObject(parent), m_replaysDirectory(replaysDir)
+    : QObject(parent)
+    , m_replaysDirectory(replaysDir)
+    , m_progress(std::make_shared<ScanProgress>())
+    , m_maxThreadCount(QThread::idealThreadCount())
+    , m_batchSize(256)
+    , m_flushCount(200)
+    , m_flushIntervalMs(250)
 {
-    loadTankMapping();
 }
 
 ReplayScanner::~ReplayScanner()
@@ -21,99 +31,293 @@ ReplayScanner::~ReplayScanner()
 
 void ReplayScanner::doScan()
 {
-    QList<ReplayInfo> newReplaysData;
-    QDir dir(m_replaysDirectory);
-    QStringList filters;
-    filters << "*.wotreplay";
-    QFileInfoList fileList = dir.entryInfoList(filters, QDir::Files | QDir::NoDotAndDotDot);
+    QFileInfoList fileList = replayFiles(m_replaysDirectory);
 
+    // Collect the files that actually need parsing; unchanged known files are skipped up front
+    QSet<QString> diskPaths;
+    diskPaths.reserve(fileList.size());
+    QStringList pendingPaths;
+    QList<ReplayFingerprint> pendingFingerprints;
     for (const auto& fileInfo : fileList) {
         if (QThread::currentThread()->isInterruptionRequested()) {
             return;
         }
 
-        emit scanProgress(fileInfo.fileName());
-
         QString filePath = fileInfo.absoluteFilePath();
+        diskPaths.insert(filePath);
+        ReplayFingerprint fingerprint = fingerprintFor(fileInfo);
+        m_progress->enumerated.fetch_add(1, std::memory_order_relaxed);
 
-        if (m_knownReplayPaths.contains(filePath)) {
-            qDebug() << "Skipping known file:" << fileInfo.fileName();
+        auto known = m_knownReplays.constFind(filePath);
+        if (known != m_knownReplays.constEnd() && known.value() == fingerprint) {
+            m_progress->skipped.fetch_add(1, std::memory_order_relaxed);
             continue;
         }
 
-        QByteArray filePathBytes = filePath.toUtf8();
-        const char* path_c_str = filePathBytes.constData();
+        pendingPaths.append(filePath);
+        pendingFingerprints.append(fingerprint);
+        m_progress->queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_progress->enumerationDone.store(true, std::memory_order_release);
 
-        const char* result_c_str = parse_replay(path_c_str);
-        if (result_c_str == nullptr) {
-            continue;
-        }
+    // The library threads poll the scan thread's interruption flag before every file
+    QThread* scanThread = QThread::currentThread();
+    auto shouldCancel = [](void* context) -> bool {
+        return static_cast<QThread*>(context)->isInterruptionRequested();
+    };
 
-        QString result_json_str = QString::fromUtf8(result_c_str);
-        free_string(const_cast<char*>(result_c_str));
+    const int maxBatchSize = qMax(1, m_batchSize);
+    const size_t threadCount = size_t(qMax(1, m_maxThreadCount));
 
-        if (result_json_str.startsWith("Failed to parse replay:") || result_json_str.startsWith("Failed to serialize to JSON:")) {
-            continue;
+    // Start with small batches so the first rows reach the UI quickly, then grow to the full size
+    int batchSize = qMin(maxBatchSize, qMax(16, int(threadCount)));
+
+    QList<ReplayInfo> newReplaysData;
+    QList<BattleResults> newBattleResults;
+    QElapsedTimer sinceFlush;
+    sinceFlush.start();
+
+    std::vector<QByteArray> batchPathBytes;
+    std::vector<const char*> batchPaths;
+    std::vector<WotReplayResult> batchResults;
+
+    qsizetype batchStart = 0;
+    while (batchStart < pendingPaths.size()) {
+        if (scanThread->isInterruptionRequested()) {
+            return;
         }
 
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(result_json_str.toUtf8(), &parseError);
+        const qsizetype batchEnd = qMin(batchStart + batchSize, pendingPaths.size());
+        const size_t count = size_t(batchEnd - batchStart);
 
-        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-            continue;
+        batchPathBytes.clear();
+        batchPathBytes.reserve(count);
+        batchPaths.clear();
+        for (qsizetype i = batchStart; i < batchEnd; ++i) {
+            batchPathBytes.push_back(pendingPaths.at(i).toUtf8());
+            batchPaths.push_back(batchPathBytes.back().constData());
         }
+        batchResults.resize(count);
 
-        QJsonObject obj = doc.object();
-        ReplayInfo info;
-        info.path = filePath;
-        info.playerName = obj.value("playerName").toString();
+        // Table and battle results both come from the JSON header blocks, so skip the packet stream entirely
+        parse_replays(batchPaths.data(), count, batchResults.data(), WOT_PARSE_METADATA_ONLY | WOT_PARSE_BATTLE_RESULTS,
+                      threadCount, shouldCancel, scanThread);
 
-        QString fullTankStr = obj.value("tank").toString();
-        //qDebug() << "Full Tank String" << fullTankStr;
-        QString suffixLabel;
+        // Results are index-addressed, so they come back in directory order
+        qint64 batchParsed = 0;
+        qint64 batchFailed = 0;
+        qint64 batchBytes = 0;
+        for (size_t i = 0; i < count; ++i) {
+            WotReplayResult& result = batchResults[i];
+            const qsizetype index = batchStart + qsizetype(i);
+            batchBytes += qint64(result.bytes_read);
+            if (result.status == WOT_PARSE_OK) {
+                ++batchParsed;
+                ReplayInfo info;
+                info.path = pendingPaths.at(index);
+                info.fingerprint = pendingFingerprints.at(index);
+                fillReplayInfo(result, info);
 
-        if (fullTankStr.endsWith("_FEP23")) {
-            suffixLabel = " (Overwhelming Fire)";
-            fullTankStr = fullTankStr.left(fullTankStr.length() - 6);
+                // Sent even without results, so a rewritten replay drops the ones stored for its old file
+                BattleResults battle;
+                battle.path = info.path;
+                readBattleResults(result, battle);
+                newBattleResults.append(std::move(battle));
+                newReplaysData.append(std::move(info));
+            } else if (result.status != WOT_PARSE_CANCELLED) {
+                ++batchFailed;
+                qDebug() << "Failed to parse" << pendingPaths.at(index) << ":"
+                         << QString::fromUtf8(result.error.data, qsizetype(result.error.size));
+            }
+            free_replay_result(&result);
         }
-        //qDebug() << "Suffix Tank Label" << suffixLabel;
-        QString tankId = fullTankStr.section('-', 1, -1);
-        //qDebug() << "Tank ID" << tankId;
-        if (tankMap.contains(tankId)) {
-            info.tank = tankMap[tankId] + suffixLabel;
-            //qDebug() << "Tank INFO Mapped" << info.tank;
-        } else {
-            info.tank = fullTankStr + suffixLabel;
-            //qDebug() << "Tank INFO" << info.tank;
+
+        m_progress->parsed.fetch_add(batchParsed, std::memory_order_relaxed);
+        m_progress->failed.fetch_add(batchFailed, std::memory_order_relaxed);
+        m_progress->bytesRead.fetch_add(batchBytes, std::memory_order_relaxed);
+
+        if (newReplaysData.size() >= m_flushCount || sinceFlush.elapsed() >= m_flushIntervalMs) {
+            if (!newReplaysData.isEmpty()) {
+                emit replaysParsed(newReplaysData);
+                newReplaysData.clear();
+            }
+            if (!newBattleResults.isEmpty()) {
+                emit battleResultsParsed(newBattleResults);
+                newBattleResults.clear();
+            }
+            sinceFlush.restart();
         }
 
-        info.map = obj.value("map").toString();
-        info.date = obj.value("date").toString();
-        info.damage = obj.value("damage").toInt();
-        info.server = obj.value("server").toString();
-        info.version = obj.value("version").toString();
+        batchStart = batchEnd;
+        batchSize = qMin(maxBatchSize, batchSize * 2);
+    }
+
+    if (scanThread->isInterruptionRequested()) {
+        return;
+    }
 
-        newReplaysData.append(info);
+    if (!newReplaysData.isEmpty()) {
+        emit replaysParsed(newReplaysData);
+    }
+    if (!newBattleResults.isEmpty()) {
+        emit battleResultsParsed(newBattleResults);
     }
-    emit scanFinished(newReplaysData);
+    emit scanFinished(diskPaths);
 }
 
-void ReplayScanner::loadTankMapping()
+/**
+ * @brief Copies the battle results the parser library extracted from the end block.
+ * @return false if the replay has no results (incomplete replays) or they were not requested.
+ */
+bool ReplayScanner::readBattleResults(const WotReplayResult& result, BattleResults& battle)
 {
-    QFile file(":/resources/tank_mapping.json");
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Failed to open tank mapping JSON";
-        return;
+    const WotBattleResults& source = result.battle;
+    if (!source.present) {
+        return false;
     }
-    QByteArray data = file.readAll();
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        qDebug() << "Failed to parse tank mapping JSON:" << parseError.errorString();
-        return;
+
+    auto toQString = [](const WotReplayStr& str) {
+        return QString::fromUtf8(str.data, qsizetype(str.size));
+    };
+
+    battle.present = true;
+    battle.arenaUniqueId = toQString(source.arena_unique_id);
+    battle.arenaTypeId = source.arena_type_id;
+    battle.winnerTeam = source.winner_team;
+    battle.finishReason = source.finish_reason;
+    battle.duration = source.duration;
+
+    const WotPersonalResult& personal = source.personal;
+    if (personal.present) {
+        PersonalResult& own = battle.personal;
+        own.present = true;
+        own.team = personal.team;
+        own.outcome = personal.outcome;
+        own.xp = personal.xp;
+        own.credits = personal.credits;
+        own.kills = personal.kills;
+        own.damageDealt = personal.damage_dealt;
+        own.damageAssistedRadio = personal.damage_assisted_radio;
+        own.damageAssistedTrack = personal.damage_assisted_track;
+        own.spotted = personal.spotted;
+        own.damageReceived = personal.damage_received;
+        own.shots = personal.shots;
+        own.directHits = personal.direct_hits;
+        own.piercings = personal.piercings;
+        own.lifeTime = personal.life_time;
     }
-    QJsonObject obj = doc.object();
-    for (auto it = obj.begin(); it != obj.end(); ++it) {
-        tankMap[it.key()] = it.value().toString();
+
+    battle.participants.reserve(qsizetype(source.participant_count));
+    for (size_t i = 0; i < source.participant_count; ++i) {
+        const WotBattleParticipant& entry = source.participants[i];
+        BattleParticipant participant;
+        participant.vehicleId = entry.vehicle_id;
+        participant.accountDbId = entry.account_db_id;
+        participant.name = toQString(entry.name);
+        participant.clan = toQString(entry.clan);
+        participant.team = entry.team;
+        participant.vehicle = toQString(entry.vehicle);
+        participant.damageDealt = entry.damage_dealt;
+        participant.kills = entry.kills;
+        participant.xp = entry.xp;
+        participant.spotted = entry.spotted;
+        participant.damageAssisted = entry.damage_assisted;
+        participant.survived = entry.survived;
+        battle.participants.append(std::move(participant));
     }
+    return true;
+}
+
+/**
+ * @brief Lists the .wotreplay files directly inside a replay directory.
+ */
+QFileInfoList ReplayScanner::replayFiles(const QString& replaysDir)
+{
+    QDir dir(replaysDir);
+    QStringList filters;
+    filters << "*.wotreplay";
+    return dir.entryInfoList(filters, QDir::Files | QDir::NoDotAndDotDot);
+}
+
+/**
+ * @brief Converts the game's "dd.MM.yyyy HH:mm:ss" battle date into a sortable epoch value.
+ * The wall-clock time is taken as UTC, matching the backfill done by the schema migration,
+ * so the value orders battles correctly without depending on the local time zone.
+ * @return Seconds since epoch, or 0 if the date cannot be parsed.
+ */
+qint64 ReplayScanner::battleTimeFromDate(const QString& date)
+{
+    const QDate day = QDate::fromString(date.left(10), "dd.MM.yyyy");
+    const QTime time = QTime::fromString(date.mid(11, 8), "HH:mm:ss");
+    if (!day.isValid() || !time.isValid()) {
+        return 0;
+    }
+    return QDateTime(day, time, QTimeZone::utc()).toSecsSinceEpoch();
+}
+
+/**
+ * @brief Builds the size/mtime/inode fingerprint of a replay file from a single stat.
+ */
+ReplayFingerprint ReplayScanner::fingerprintFor(const QFileInfo& fileInfo)
+{
+    ReplayFingerprint fingerprint;
+#ifdef Q_OS_UNIX
+    // QFileInfo has no inode accessor, so take all three fields from one stat call
+    struct stat st;
+    if (::stat(QFile::encodeName(fileInfo.absoluteFilePath()).constData(), &st) == 0) {
+        fingerprint.size = static_cast<qint64>(st.st_size);
+#ifdef Q_OS_DARWIN
+        const struct timespec& modified = st.st_mtimespec;
+#else
+        const struct timespec& modified = st.st_mtim;
+#endif
+        // Milliseconds, like QFileInfo::lastModified(), so a rewrite within the same second still changes it
+        fingerprint.mtime = static_cast<qint64>(modified.tv_sec) * 1000 + modified.tv_nsec / 1000000;
+        fingerprint.inode = static_cast<quint64>(st.st_ino);
+        return fingerprint;
+    }
+#endif
+    fingerprint.size = fileInfo.size();
+    fingerprint.mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+    return fingerprint;
+}
+
+/**
+ * @brief Maps a successful parser result to a ReplayInfo, resolving the tank name.
+ * Strings are decoded straight out of the library's buffer; the result still has to be freed.
+ */
+void ReplayScanner::fillReplayInfo(const WotReplayResult& result, ReplayInfo& info) const
+{
+    auto toQString = [](const WotReplayStr& str) {
+        return QString::fromUtf8(str.data, qsizetype(str.size));
+    };
+
+    info.playerName = toQString(result.player_name);
+
+    QString fullTankStr = toQString(result.tank);
+    //qDebug() << "Full Tank String" << fullTankStr;
+    QString suffixLabel;
+
+    if (fullTankStr.endsWith("_FEP23")) {
+        suffixLabel = " (Overwhelming Fire)";
+        fullTankStr = fullTankStr.left(fullTankStr.length() - 6);
+    }
+    //qDebug() << "Suffix Tank Label" << suffixLabel;
+    QString tankId = fullTankStr.section('-', 1, -1);
+    //qDebug() << "Tank ID" << tankId;
+    QString mappedName = TankMapping::instance().displayName(tankId);
+    if (!mappedName.isEmpty()) {
+        info.tank = mappedName + suffixLabel;
+        //qDebug() << "Tank INFO Mapped" << info.tank;
+    } else {
+        info.tank = fullTankStr + suffixLabel;
+        //qDebug() << "Tank INFO" << info.tank;
+    }
+
+    info.map = toQString(result.map);
+    info.date = toQString(result.date);
+    info.battleTime = battleTimeFromDate(info.date);
+    info.damage = int(result.damage);
+    info.server = toQString(result.server);
+    info.version = toQString(result.version);
 }
@@ -4,9 +4,38 @@
 #include <QObject>
 #include <QDir>
 #include <QSet>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QMap>
+#include <QHash>
+#include <QFileInfo>
+#include <atomic>
+#include <memory>
+
+struct WotReplayResult;
+
+// Live scan counters. The scanner only bumps them; the UI samples them at its own pace,
+// so progress reporting costs nothing per file on the GUI thread.
+struct ScanProgress {
+    std::atomic<qint64> enumerated{0}; // Replay files found in the directory
+    std::atomic<qint64> skipped{0};    // Known files with an unchanged fingerprint
+    std::atomic<qint64> queued{0};     // Files that need parsing
+    std::atomic<qint64> parsed{0};
+    std::atomic<qint64> failed{0};
+    std::atomic<qint64> bytesRead{0};
+    std::atomic<bool> enumerationDone{false};
+};
+
+// Cheap on-disk identity of a replay file, used to detect files overwritten in place.
+struct ReplayFingerprint {
+    qint64 size = 0;
+    qint64 mtime = 0; // Last modification time in ms since epoch
+    quint64 inode = 0; // 0 where the platform has no inode numbers
+
+    bool operator==(const ReplayFingerprint& other) const {
+        return size == other.size && mtime == other.mtime && inode == other.inode;
+    }
+    bool operator!=(const ReplayFingerprint& other) const {
+        return !(*this == other);
+    }
+};
 
 struct ReplayInfo {
     QString path;
@@ -14,9 +43,60 @@ struct ReplayInfo {
     QString tank;
     QString map;
     QString date;
+    qint64 battleTime = 0; // date as seconds since epoch, for sorting and range filters; 0 if unknown
     int damage;
     QString server;
     QString version;
+    ReplayFingerprint fingerprint;
+};
+
+// Statistics of one player's vehicle in a battle, from the end-of-battle results.
+struct BattleParticipant {
+    qint64 vehicleId = 0;
+    qint64 accountDbId = 0;
+    QString name;
+    QString clan;
+    int team = 0;
+    QString vehicle; // "nation:tag", e.g. "ussr:R04_T-34"
+    int damageDealt = 0;
+    int kills = 0;
+    int xp = 0;
+    int spotted = 0;
+    int damageAssisted = 0; // Radio plus track assistance
+    bool survived = false;
+};
+
+// Figures of the recording player only.
+struct PersonalResult {
+    bool present = false;
+    int team = 0;
+    int outcome = 0; // 1 win, 0 draw, -1 loss
+    int xp = 0;
+    int credits = 0;
+    int kills = 0;
+    int damageDealt = 0;
+    int damageAssistedRadio = 0;
+    int damageAssistedTrack = 0;
+    int spotted = 0;
+    int damageReceived = 0;
+    int shots = 0;
+    int directHits = 0;
+    int piercings = 0;
+    int lifeTime = 0; // Seconds
+};
+
+// Everything the cache keeps from a replay's end-of-battle results, extracted once at scan time.
+// Without `present` the replay had no results, and only its previously stored ones are removed.
+struct BattleResults {
+    QString path;
+    bool present = false;
+    QString arenaUniqueId; // Exceeds 2^53, so kept as text
+    int arenaTypeId = 0;
+    int winnerTeam = 0;
+    int finishReason = 0;
+    int duration = 0; // Seconds
+    PersonalResult personal;
+    QList<BattleParticipant> participants;
 };
 
 class ReplayScanner : public QObject
@@ -26,25 +106,59 @@ public:
     explicit ReplayScanner(const QString& replaysDir, QObject *parent = nullptr);
     ~ReplayScanner();
 
-    void setKnownReplayPaths(const QSet<QString>& knownPaths) {
-        m_knownReplayPaths = knownPaths;
+    // Replays already in the cache; only files whose fingerprint differs get reparsed.
+    void setKnownReplays(const QHash<QString, ReplayFingerprint>& knownReplays) {
+        m_knownReplays = knownReplays;
+    }
+
+    // Number of parser library threads used per batch (values < 1 fall back to one thread).
+    void setMaxThreadCount(int maxThreadCount) {
+        m_maxThreadCount = maxThreadCount;
+    }
+
+    // Number of files handed to the parser library per parse_replays call.
+    void setBatchSize(int batchSize) {
+        m_batchSize = batchSize;
+    }
+
+    // Parsed replays are delivered through replaysParsed once this many have accumulated
+    // or this much time has passed since the last delivery, whichever comes first.
+    void setResultFlushThresholds(int count, int intervalMs) {
+        m_flushCount = count;
+        m_flushIntervalMs = intervalMs;
     }
 
+    // Counters for this scan; stays valid for holders after the scanner is deleted.
+    std::shared_ptr<const ScanProgress> progress() const {
+        return m_progress;
+    }
+
+    static ReplayFingerprint fingerprintFor(const QFileInfo& fileInfo);
+    static QFileInfoList replayFiles(const QString& replaysDir);
+    static qint64 battleTimeFromDate(const QString& date);
 
 public slots:
     void doScan();
 
 signals:
-    void scanFinished(const QList<ReplayInfo>& replays);
-    void scanProgress(const QString& currentFile);
+    // Partial results, emitted repeatedly while the scan runs
+    void replaysParsed(const QList<ReplayInfo>& replays);
+    // End-of-battle results of the same replays; incomplete replays come without `present`
+    void battleResultsParsed(const QList<BattleResults>& results);
+    // Emitted once after the last replaysParsed batch, with every replay path found on disk
+    void scanFinished(const QSet<QString>& diskPaths);
 
 private:
-    void loadTankMapping();
+    void fillReplayInfo(const WotReplayResult& result, ReplayInfo& info) const;
+    static bool readBattleResults(const WotReplayResult& result, BattleResults& battle);
 
     QString m_replaysDirectory;
-    QMap<QString, QString> tankMap;
-
-    QSet<QString> m_knownReplayPaths;
+    QHash<QString, ReplayFingerprint> m_knownReplays;
+    std::shared_ptr<ScanProgress> m_progress;
+    int m_maxThreadCount;
+    int m_batchSize;
+    int m_flushCount;
+    int m_flushIntervalMs;
 };
 
 #endif // REPLAYSCANNER_H
@@ -0,0 +1,278 @@
+#include "replaysnapshot.h"
+#include <QDebug>
+#include <QHash>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+
+constexpr quint32 kSnapshotMagic = 0x4E535257; // "WRSN" in little-endian byte order
+constexpr quint32 kSnapshotVersion = 1;
+constexpr int kStringColumnCount = 7;
+
+// Fixed-size header at offset 0. Everything after it is 8-byte aligned.
+struct SnapshotHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 rowCount;
+    quint32 stringCount;
+    quint64 stringCharCount;
+    quint64 fileSize;
+};
+static_assert(sizeof(SnapshotHeader) == 32, "snapshot header layout changed");
+
+constexpr quint64 align8(quint64 offset)
+{
+    return (offset + 7) & ~quint64(7);
+}
+
+// Offsets of every section; fully determined by the three counts in the header
+struct SnapshotLayout {
+    quint64 stringIndex;
+    quint64 stringData;
+    quint64 stringColumns[kStringColumnCount];
+    quint64 damage;
+    quint64 battleTime;
+    quint64 fileSize;
+    quint64 mtime;
+    quint64 inode;
+    quint64 end;
+
+    SnapshotLayout(quint64 rows, quint64 strings, quint64 chars)
+    {
+        quint64 offset = sizeof(SnapshotHeader);
+        stringIndex = offset;
+        offset = align8(offset + strings * 2 * sizeof(quint32));
+        stringData = offset;
+        offset = align8(offset + chars * sizeof(QChar));
+        for (quint64& column : stringColumns) {
+            column = offset;
+            offset = align8(offset + rows * sizeof(quint32));
+        }
+        damage = offset;
+        offset = align8(offset + rows * sizeof(qint32));
+        battleTime = offset;
+        offset += rows * sizeof(qint64);
+        fileSize = offset;
+        offset += rows * sizeof(qint64);
+        mtime = offset;
+        offset += rows * sizeof(qint64);
+        inode = offset;
+        offset += rows * sizeof(quint64);
+        end = offset;
+    }
+};
+
+const QString& stringField(const ReplayInfo& info, int column)
+{
+    switch (column) {
+    case 0: return info.path;
+    case 1: return info.playerName;
+    case 2: return info.tank;
+    case 3: return info.map;
+    case 4: return info.date;
+    case 5: return info.server;
+    default: return info.version;
+    }
+}
+
+template<typename T>
+void appendArray(QByteArray& out, const QList<T>& values)
+{
+    out.append(reinterpret_cast<const char*>(values.constData()), values.size() * qsizetype(sizeof(T)));
+    out.append(QByteArray(qsizetype(align8(out.size()) - out.size()), '\0'));
+}
+
+} // namespace
+
+ReplaySnapshot::~ReplaySnapshot()
+{
+    close();
+}
+
+/**
+ * @brief Encodes the replays into the columnar snapshot format and replaces filePath with it.
+ */
+bool ReplaySnapshot::write(const QString& filePath, const QList<ReplayInfo>& replays)
+{
+    // Dictionary-encode all string columns; tank, map, server and version repeat heavily
+    QHash<QString, quint32> dictionary;
+    QList<quint32> stringIndex;
+    QString stringData;
+    QList<quint32> stringColumns[kStringColumnCount];
+
+    for (int column = 0; column < kStringColumnCount; ++column) {
+        stringColumns[column].reserve(replays.size());
+    }
+    for (const ReplayInfo& info : replays) {
+        for (int column = 0; column < kStringColumnCount; ++column) {
+            const QString& value = stringField(info, column);
+            auto it = dictionary.constFind(value);
+            if (it == dictionary.constEnd()) {
+                it = dictionary.insert(value, quint32(dictionary.size()));
+                stringIndex << quint32(stringData.size()) << quint32(value.size());
+                stringData += value;
+            }
+            stringColumns[column] << it.value();
+        }
+    }
+
+    QList<qint32> damage;
+    QList<qint64> battleTime, fileSize, mtime;
+    QList<quint64> inode;
+    for (const ReplayInfo& info : replays) {
+        damage << info.damage;
+        battleTime << info.battleTime;
+        fileSize << info.fingerprint.size;
+        mtime << info.fingerprint.mtime;
+        inode << info.fingerprint.inode;
+    }
+
+    const SnapshotLayout layout(quint64(replays.size()), quint64(dictionary.size()), quint64(stringData.size()));
+    SnapshotHeader header = {};
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.rowCount = quint32(replays.size());
+    header.stringCount = quint32(dictionary.size());
+    header.stringCharCount = quint64(stringData.size());
+    header.fileSize = layout.end;
+
+    QByteArray out;
+    out.reserve(qsizetype(layout.end));
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    appendArray(out, stringIndex);
+    out.append(reinterpret_cast<const char*>(stringData.constData()), stringData.size() * qsizetype(sizeof(QChar)));
+    out.append(QByteArray(qsizetype(align8(out.size()) - out.size()), '\0'));
+    for (const QList<quint32>& column : stringColumns) {
+        appendArray(out, column);
+    }
+    appendArray(out, damage);
+    appendArray(out, battleTime);
+    appendArray(out, fileSize);
+    appendArray(out, mtime);
+    appendArray(out, inode);
+    Q_ASSERT(quint64(out.size()) == layout.end);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        qWarning() << "Failed to write replay snapshot" << filePath << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Maps the snapshot read-only and checks that its layout fits the file.
+ */
+bool ReplaySnapshot::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(SnapshotHeader))) {
+        close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        qWarning() << "Failed to map replay snapshot" << filePath << ":" << m_file.errorString();
+        close();
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion
+        || header.fileSize != quint64(m_size)) {
+        qDebug() << "Ignoring outdated or foreign replay snapshot" << filePath;
+        close();
+        return false;
+    }
+
+    const SnapshotLayout layout(header.rowCount, header.stringCount, header.stringCharCount);
+    if (layout.end != header.fileSize) {
+        qWarning() << "Ignoring corrupt replay snapshot" << filePath;
+        close();
+        return false;
+    }
+
+    m_rowCount = int(header.rowCount);
+    m_stringCount = header.stringCount;
+    m_stringCharCount = header.stringCharCount;
+    m_stringIndex = reinterpret_cast<const quint32*>(m_data + layout.stringIndex);
+    m_stringData = reinterpret_cast<const QChar*>(m_data + layout.stringData);
+    for (int column = 0; column < kStringColumnCount; ++column) {
+        m_stringColumns[column] = reinterpret_cast<const quint32*>(m_data + layout.stringColumns[column]);
+    }
+    m_damage = reinterpret_cast<const qint32*>(m_data + layout.damage);
+    m_battleTime = reinterpret_cast<const qint64*>(m_data + layout.battleTime);
+    m_fileSize = reinterpret_cast<const qint64*>(m_data + layout.fileSize);
+    m_mtime = reinterpret_cast<const qint64*>(m_data + layout.mtime);
+    m_inode = reinterpret_cast<const quint64*>(m_data + layout.inode);
+    return true;
+}
+
+void ReplaySnapshot::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_rowCount = 0;
+    m_stringCount = 0;
+    m_stringCharCount = 0;
+}
+
+QString ReplaySnapshot::string(quint32 id) const
+{
+    if (id >= m_stringCount) {
+        return QString();
+    }
+    const quint32 offset = m_stringIndex[2 * id];
+    const quint32 length = m_stringIndex[2 * id + 1];
+    if (quint64(offset) + length > m_stringCharCount) {
+        return QString();
+    }
+    return QString(m_stringData + offset, qsizetype(length));
+}
+
+ReplayInfo ReplaySnapshot::replayAt(int row) const
+{
+    ReplayInfo info;
+    if (row < 0 || row >= m_rowCount) {
+        return info;
+    }
+
+    info.path = string(m_stringColumns[0][row]);
+    info.playerName = string(m_stringColumns[1][row]);
+    info.tank = string(m_stringColumns[2][row]);
+    info.map = string(m_stringColumns[3][row]);
+    info.date = string(m_stringColumns[4][row]);
+    info.server = string(m_stringColumns[5][row]);
+    info.version = string(m_stringColumns[6][row]);
+    info.damage = m_damage[row];
+    info.battleTime = m_battleTime[row];
+    info.fingerprint.size = m_fileSize[row];
+    info.fingerprint.mtime = m_mtime[row];
+    info.fingerprint.inode = m_inode[row];
+    return info;
+}
+
+QList<ReplayInfo> ReplaySnapshot::replays(int first, int count) const
+{
+    QList<ReplayInfo> result;
+    const int last = qMin(m_rowCount, first + count);
+    result.reserve(qMax(0, last - first));
+    for (int row = qMax(0, first); row < last; ++row) {
+        result.append(replayAt(row));
+    }
+    return result;
+}
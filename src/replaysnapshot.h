@@ -0,0 +1,57 @@
+#ifndef REPLAYSNAPSHOT_H
+#define REPLAYSNAPSHOT_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include "replayscanner.h"
+
+// Compact binary copy of the replay list, written after each sync and memory-mapped at launch
+// so the first screen can be shown before SQLite has been opened.
+//
+// The file is columnar: every string column is an array of ids into one shared dictionary of
+// UTF-16 strings, and every numeric column is a plain array, so reading row N touches only a
+// few fixed offsets. Rows keep the order they were written in (newest battle first).
+// The snapshot is only a cache; the database stays the source of truth.
+class ReplaySnapshot
+{
+public:
+    ReplaySnapshot() = default;
+    ~ReplaySnapshot();
+
+    // Writes the replays atomically (via a temporary file) in the given order.
+    static bool write(const QString& filePath, const QList<ReplayInfo>& replays);
+
+    // Maps an existing snapshot. Returns false for missing, truncated or foreign files.
+    bool open(const QString& filePath);
+    void close();
+
+    int rowCount() const { return m_rowCount; }
+    ReplayInfo replayAt(int row) const;
+    QList<ReplayInfo> replays(int first, int count) const;
+
+    ReplaySnapshot(const ReplaySnapshot&) = delete;
+    ReplaySnapshot& operator=(const ReplaySnapshot&) = delete;
+
+private:
+    QString string(quint32 id) const;
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    int m_rowCount = 0;
+    quint32 m_stringCount = 0;
+    quint64 m_stringCharCount = 0;
+
+    // Pointers into the mapping
+    const quint32* m_stringIndex = nullptr; // (offset, length) pairs in UTF-16 units
+    const QChar* m_stringData = nullptr;
+    const quint32* m_stringColumns[7] = {};
+    const qint32* m_damage = nullptr;
+    const qint64* m_battleTime = nullptr;
+    const qint64* m_fileSize = nullptr;
+    const qint64* m_mtime = nullptr;
+    const quint64* m_inode = nullptr;
+};
+
+#endif // REPLAYSNAPSHOT_H
@@ -0,0 +1,807 @@
+#include "replaytablemodel.h"
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace {
+
+// Beyond this many new rows one layout change is cheaper than notifying each insert
+constexpr int kIncrementalInsertLimit = 256;
+
+// Rows between two checks for a newer filter in the background evaluation
+constexpr int kFilterCancelCheckInterval = 4096;
+
+template<typename T>
+int compareKeys(T a, T b)
+{
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+// Checks the filter words against a row; termMatches(term, stringId) tests one pooled string
+template<typename Row, typename TermMatches>
+bool rowMatches(const Row& row, const ReplayFilter& filter, TermMatches&& termMatches)
+{
+    if (row.path.isEmpty() || !filter.matchesBounds(row.damage, row.battleTime)) {
+        return false;
+    }
+    // The full-text index has already answered every plain word at once
+    if (filter.fullTextMatches && !filter.fullTextMatches->contains(row.path)) {
+        return false;
+    }
+    for (int term = 0; term < filter.terms.size(); ++term) {
+        bool hit;
+        switch (filter.terms[term].field) {
+        case ReplayFilter::PlayerField: hit = termMatches(term, row.playerName); break;
+        case ReplayFilter::TankField: hit = termMatches(term, row.tank); break;
+        case ReplayFilter::MapField: hit = termMatches(term, row.map); break;
+        case ReplayFilter::ServerField: hit = termMatches(term, row.server); break;
+        case ReplayFilter::VersionField: hit = termMatches(term, row.version); break;
+        default:
+            hit = filter.fullTextMatches.has_value()
+                || termMatches(term, row.playerName) || termMatches(term, row.tank) || termMatches(term, row.map);
+            break;
+        }
+        if (!hit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ReplayTableModel::ReplayTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_filterGeneration(std::make_shared<std::atomic<quint64>>(0))
+    , m_collator(QLocale::system())
+    , m_locale(QLocale::system())
+{
+    // "1.10" after "1.9", and "t-34" next to "T-34"
+    m_collator.setNumericMode(true);
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    m_permutationBuilt[m_sortColumn] = true;
+}
+
+ReplayTableModel::~ReplayTableModel()
+{
+    // Lets a filter still running on the pool stop early; its result has nowhere to go
+    m_filterGeneration->fetch_add(1);
+}
+
+int ReplayTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(m_shown.size());
+}
+
+int ReplayTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ReplayTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    const ReplayRow& row = m_rows[slotAt(index.row())];
+
+    if (role == Qt::UserRole) {
+        // The full replay path, for launching the replay
+        return row.path;
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case PlayerColumn: return m_strings[row.playerName];
+    case TankColumn: return m_strings[row.tank];
+    case MapColumn: return m_strings[row.map];
+    case DateColumn: return row.date;
+    case DamageColumn: return m_locale.toString(row.damage);
+    case ServerColumn: return m_strings[row.server];
+    case VersionColumn: return m_strings[row.version];
+    default: return QVariant();
+    }
+}
+
+QVariant ReplayTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+
+    switch (section) {
+    case PlayerColumn: return QStringLiteral("Player");
+    case TankColumn: return QStringLiteral("Tank");
+    case MapColumn: return QStringLiteral("Map");
+    case DateColumn: return QStringLiteral("Date");
+    case DamageColumn: return QStringLiteral("Damage");
+    case ServerColumn: return QStringLiteral("Server");
+    case VersionColumn: return QStringLiteral("Version");
+    default: return QVariant();
+    }
+}
+
+/**
+ * @brief Shows the rows ordered by a column. The first sort by a column builds its permutation;
+ * after that, switching columns or direction reuses it. Persistent indexes follow their rows.
+ */
+void ReplayTableModel::sort(int column, Qt::SortOrder order)
+{
+    if (column < 0 || column >= ColumnCount || (column == m_sortColumn && order == m_sortOrder)) {
+        return;
+    }
+
+    relayout([this, column, order]() {
+        if (!m_permutationBuilt[column]) {
+            buildPermutation(column);
+        }
+        m_sortColumn = column;
+        m_sortOrder = order;
+        rebuildShown();
+    });
+}
+
+void ReplayTableModel::setReplays(const QList<ReplayInfo>& replays)
+{
+    beginResetModel();
+    m_rows.clear();
+    m_freeSlots.clear();
+    m_slotForPath.clear();
+    m_strings.clear();
+    m_stringIds.clear();
+    m_collationKeys.clear();
+    m_collationOrder.clear();
+    m_collationRanks.clear();
+    for (int column = 0; column < ColumnCount; ++column) {
+        m_permutations[column].clear();
+        m_permutationBuilt[column] = false;
+        m_longestText[column].clear();
+    }
+    m_maxDamage = 0;
+
+    m_rows.reserve(replays.size());
+    m_slotForPath.reserve(replays.size());
+    for (const ReplayInfo& info : replays) {
+        const int slot = m_slotForPath.value(info.path, -1);
+        if (slot >= 0) {
+            m_rows[slot] = makeRow(info);
+        } else {
+            allocateSlot(info);
+        }
+    }
+
+    // Only the shown column is sorted now; the others wait until their header is clicked
+    buildPermutation(m_sortColumn);
+    if (!m_filter.isEmpty()) {
+        m_matches = evaluateFilter(m_rows, m_strings, m_filter, {}, []() { return false; });
+    }
+    rebuildShown();
+    endResetModel();
+}
+
+/**
+ * @brief Applies a batch of new and rewritten replays as row-level changes.
+ * A new replay becomes a single-row insert at its sorted position. A rewritten one is updated
+ * in place, or moved by a remove and an insert if its sort key changed. Batches too large for
+ * row-by-row inserts are appended and sorted once; persistent indexes survive either way.
+ */
+void ReplayTableModel::mergeReplays(const QList<ReplayInfo>& replays)
+{
+    QList<int> addedSlots;
+    QSet<int> addedSet;
+    for (const ReplayInfo& info : replays) {
+        const int slot = m_slotForPath.value(info.path, -1);
+        if (slot < 0) {
+            const int added = allocateSlot(info);
+            addedSlots.append(added);
+            addedSet.insert(added);
+        } else if (addedSet.contains(slot)) {
+            // Same path twice in one batch; the slot is not in any order yet
+            m_rows[slot] = makeRow(info);
+        } else {
+            updateSlot(slot, info);
+        }
+    }
+
+    if (addedSlots.size() <= kIncrementalInsertLimit) {
+        for (int slot : std::as_const(addedSlots)) {
+            insertRow(slot);
+        }
+        return;
+    }
+
+    // The other columns are re-sorted from scratch the next time they are shown
+    for (int column = 0; column < ColumnCount; ++column) {
+        if (column != m_sortColumn) {
+            m_permutations[column].clear();
+            m_permutationBuilt[column] = false;
+        }
+    }
+
+    QList<int>& permutation = m_permutations[m_sortColumn];
+    permutation.append(addedSlots);
+
+    QList<int> shownSlots;
+    for (int slot : std::as_const(addedSlots)) {
+        updateMatch(slot);
+        if (matchesFilter(slot)) {
+            shownSlots.append(slot);
+        }
+    }
+
+    // New rows go in unsorted at the end of the shown order, then one layout change sorts them
+    if (!shownSlots.isEmpty()) {
+        const int first = m_sortOrder == Qt::AscendingOrder ? int(m_shown.size()) : 0;
+        beginInsertRows(QModelIndex(), first, first + int(shownSlots.size()) - 1);
+        if (m_sortOrder == Qt::AscendingOrder) {
+            m_shown.append(shownSlots);
+        } else {
+            shownSlots.append(m_shown);
+            m_shown = std::move(shownSlots);
+        }
+        endInsertRows();
+    }
+
+    relayout([this, &permutation]() {
+        const int column = m_sortColumn;
+        std::sort(permutation.begin(), permutation.end(), [this, column](int a, int b) {
+            return lessThan(column, a, b);
+        });
+        rebuildShown();
+    });
+}
+
+/**
+ * @brief Removes the rows of the given paths bottom-up, one beginRemoveRows per contiguous run.
+ */
+void ReplayTableModel::removeReplays(const QSet<QString>& paths)
+{
+    QList<int> removedSlots, rows;
+    for (const QString& path : paths) {
+        const int slot = m_slotForPath.value(path, -1);
+        if (slot < 0) {
+            continue;
+        }
+        removedSlots.append(slot);
+        const int row = rowForSlot(slot);
+        if (row >= 0) {
+            rows.append(row);
+        }
+    }
+    if (removedSlots.isEmpty()) {
+        return;
+    }
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+
+    for (int i = 0; i < rows.size();) {
+        const int last = rows[i];
+        int first = last;
+        while (++i < rows.size() && rows[i] == first - 1) {
+            first = rows[i];
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        m_shown.remove(first, last - first + 1);
+        endRemoveRows();
+    }
+
+    // The cached permutations drop the same slots in one pass each
+    QList<bool> removed(m_rows.size(), false);
+    for (int slot : std::as_const(removedSlots)) {
+        removed[slot] = true;
+    }
+    for (int column = 0; column < ColumnCount; ++column) {
+        if (m_permutationBuilt[column]) {
+            m_permutations[column].removeIf([&removed](int slot) {
+                return removed[slot];
+            });
+        }
+    }
+
+    // Only now, since the binary searches above still compare against these rows
+    for (int slot : std::as_const(removedSlots)) {
+        releaseSlot(slot);
+    }
+}
+
+/**
+ * @brief Shows only the replays matching a filter. The evaluation runs on a pool thread over
+ * an implicitly shared copy of the rows. A filter that narrows the current one only rechecks
+ * the current matches. Every call makes earlier evaluations stale: they stop at their next
+ * check and their results are dropped, so only the latest keystroke is ever applied.
+ */
+void ReplayTableModel::setFilter(const ReplayFilter& filter)
+{
+    const quint64 generation = m_filterGeneration->fetch_add(1) + 1;
+
+    if (filter.isEmpty()) {
+        applyFilterResult(filter, {}, m_revision);
+        return;
+    }
+
+    QList<bool> candidates; // Empty means every live row
+    if (filter.fullTextMatches) {
+        // Only rows the index matched can pass
+        candidates.resize(m_rows.size(), false);
+        for (const QString& path : *filter.fullTextMatches) {
+            const int slot = m_slotForPath.value(path, -1);
+            if (slot >= 0) {
+                candidates[slot] = true;
+            }
+        }
+    } else if (!m_filter.isEmpty() && filter.narrows(m_filter)) {
+        candidates = m_matches;
+    }
+
+    auto* watcher = new QFutureWatcher<QList<bool>>(this);
+    connect(watcher, &QFutureWatcher<QList<bool>>::finished, this, [this, watcher, filter, generation, revision = m_revision]() {
+        watcher->deleteLater();
+        if (generation != m_filterGeneration->load()) {
+            return; // Overtaken by a newer filter
+        }
+        applyFilterResult(filter, watcher->result(), revision);
+    });
+
+    watcher->setFuture(QtConcurrent::run([rows = m_rows, strings = m_strings, filter, candidates,
+                                          counter = m_filterGeneration, generation]() {
+        return evaluateFilter(rows, strings, filter, candidates, [&counter, generation]() {
+            return counter->load(std::memory_order_relaxed) != generation;
+        });
+    }));
+}
+
+int ReplayTableModel::rowForPath(const QString& path) const
+{
+    const int slot = m_slotForPath.value(path, -1);
+    return slot >= 0 ? rowForSlot(slot) : -1;
+}
+
+QString ReplayTableModel::pathAt(int row) const
+{
+    return row >= 0 && row < rowCount() ? m_rows[slotAt(row)].path : QString();
+}
+
+QStringList ReplayTableModel::paths() const
+{
+    return m_slotForPath.keys();
+}
+
+/**
+ * @brief Expands every replay back into a ReplayInfo, in the current sort order.
+ */
+QList<ReplayInfo> ReplayTableModel::replays() const
+{
+    const QList<int>& permutation = m_permutations[m_sortColumn];
+    QList<ReplayInfo> result;
+    result.reserve(permutation.size());
+    if (m_sortOrder == Qt::AscendingOrder) {
+        for (int slot : permutation) {
+            result.append(replayFromRow(m_rows[slot]));
+        }
+    } else {
+        for (auto it = permutation.crbegin(); it != permutation.crend(); ++it) {
+            result.append(replayFromRow(m_rows[*it]));
+        }
+    }
+    return result;
+}
+
+QString ReplayTableModel::longestText(int column) const
+{
+    if (column == DamageColumn) {
+        return m_locale.toString(m_maxDamage);
+    }
+    return column >= 0 && column < ColumnCount ? m_longestText[column] : QString();
+}
+
+/**
+ * @brief Matches rows against a filter, skipping slots that are not candidates.
+ * Each word is first tested once against every pooled string, so the per-row work is a few
+ * table lookups regardless of how long the strings are.
+ * @return The match flag of every slot, or an empty list if cancelled.
+ */
+QList<bool> ReplayTableModel::evaluateFilter(const QList<ReplayRow>& rows, const QStringList& strings,
+                                             const ReplayFilter& filter, const QList<bool>& candidates,
+                                             const std::function<bool()>& cancelled)
+{
+    QList<QList<bool>> termMatches;
+    termMatches.reserve(filter.terms.size());
+    for (const ReplayFilter::Term& term : filter.terms) {
+        if (filter.fullTextMatches && term.field == ReplayFilter::AnyField) {
+            termMatches.append({}); // Answered by the index
+            continue;
+        }
+        QList<bool> matches(strings.size(), false);
+        for (int id = 0; id < strings.size(); ++id) {
+            matches[id] = strings[id].contains(term.text, Qt::CaseInsensitive);
+        }
+        termMatches.append(std::move(matches));
+        if (cancelled()) {
+            return {};
+        }
+    }
+
+    QList<bool> result(rows.size(), false);
+    for (int slot = 0; slot < rows.size(); ++slot) {
+        if (slot % kFilterCancelCheckInterval == 0 && cancelled()) {
+            return {};
+        }
+        if (!candidates.isEmpty() && (slot >= candidates.size() || !candidates[slot])) {
+            continue;
+        }
+        result[slot] = rowMatches(rows[slot], filter, [&termMatches](int term, quint32 id) {
+            return termMatches[term][id];
+        });
+    }
+    return result;
+}
+
+ReplayTableModel::ReplayRow ReplayTableModel::makeRow(const ReplayInfo& info)
+{
+    ReplayRow row;
+    row.path = info.path;
+    row.date = info.date;
+    noteLength(PlayerColumn, info.playerName);
+    noteLength(TankColumn, info.tank);
+    noteLength(MapColumn, info.map);
+    noteLength(DateColumn, info.date);
+    noteLength(ServerColumn, info.server);
+    noteLength(VersionColumn, info.version);
+    m_maxDamage = qMax(m_maxDamage, qint32(info.damage));
+    row.playerName = intern(info.playerName);
+    row.tank = intern(info.tank);
+    row.map = intern(info.map);
+    row.server = intern(info.server);
+    row.version = intern(info.version);
+    row.damage = info.damage;
+    row.battleTime = info.battleTime;
+    row.fingerprint = info.fingerprint;
+    row.revision = ++m_revision;
+    return row;
+}
+
+ReplayInfo ReplayTableModel::replayFromRow(const ReplayRow& row) const
+{
+    ReplayInfo info;
+    info.path = row.path;
+    info.playerName = m_strings[row.playerName];
+    info.tank = m_strings[row.tank];
+    info.map = m_strings[row.map];
+    info.date = row.date;
+    info.battleTime = row.battleTime;
+    info.damage = row.damage;
+    info.server = m_strings[row.server];
+    info.version = m_strings[row.version];
+    info.fingerprint = row.fingerprint;
+    return info;
+}
+
+/**
+ * @brief Returns the pool id of a string, adding it on first use. A new string is placed in
+ * the collation order right away, so the ranks of all pooled strings stay comparable.
+ */
+quint32 ReplayTableModel::intern(const QString& value)
+{
+    auto it = m_stringIds.constFind(value);
+    if (it != m_stringIds.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = quint32(m_strings.size());
+    m_stringIds.insert(value, id);
+    m_strings.append(value);
+    m_collationKeys.append(m_collator.sortKey(value));
+
+    // Inserting shifts the ranks behind it by one; existing strings keep their relative order,
+    // so every cached permutation stays sorted
+    auto position = std::upper_bound(m_collationOrder.begin(), m_collationOrder.end(), id, [this](quint32 a, quint32 b) {
+        return m_collationKeys[a].compare(m_collationKeys[b]) < 0;
+    });
+    const int rank = int(position - m_collationOrder.begin());
+    m_collationOrder.insert(rank, id);
+    m_collationRanks.append(quint32(rank));
+    for (int i = rank + 1; i < m_collationOrder.size(); ++i) {
+        m_collationRanks[m_collationOrder[i]] = quint32(i);
+    }
+    return id;
+}
+
+void ReplayTableModel::noteLength(int column, const QString& text)
+{
+    if (text.size() > m_longestText[column].size()) {
+        m_longestText[column] = text;
+    }
+}
+
+int ReplayTableModel::allocateSlot(const ReplayInfo& info)
+{
+    int slot;
+    if (!m_freeSlots.isEmpty()) {
+        slot = m_freeSlots.takeLast();
+        m_rows[slot] = makeRow(info);
+    } else {
+        slot = int(m_rows.size());
+        m_rows.append(makeRow(info));
+    }
+    m_slotForPath.insert(info.path, slot);
+    return slot;
+}
+
+/**
+ * @brief Replaces the data of a replay and moves its row wherever its new keys belong.
+ */
+void ReplayTableModel::updateSlot(int slot, const ReplayInfo& info)
+{
+    // Take the slot out of every order while its old keys still find it
+    const int row = rowForSlot(slot);
+    removeFromPermutations(slot);
+
+    m_rows[slot] = makeRow(info);
+    insertIntoPermutations(slot);
+    updateMatch(slot);
+    const bool shown = matchesFilter(slot);
+
+    // Still shown between its neighbours: the row only needs repainting
+    if (row >= 0 && shown
+        && (row == 0 || shownBefore(m_shown[row - 1], slot))
+        && (row + 1 == m_shown.size() || shownBefore(slot, m_shown[row + 1]))) {
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+        return;
+    }
+
+    // Shown before and after: move the row, so the view keeps its selection and persistent indexes
+    if (row >= 0 && shown) {
+        // Search with the row itself out of the way; its new keys no longer fit where it is
+        m_shown.remove(row);
+        const int newRow = shownPosition(slot);
+        m_shown.insert(row, slot);
+
+        // The destination counts rows of the list before the move
+        if (beginMoveRows(QModelIndex(), row, row, QModelIndex(), newRow > row ? newRow + 1 : newRow)) {
+            m_shown.move(row, newRow);
+            endMoveRows();
+        }
+        emit dataChanged(index(newRow, 0), index(newRow, ColumnCount - 1));
+        return;
+    }
+
+    if (row >= 0) {
+        beginRemoveRows(QModelIndex(), row, row);
+        m_shown.remove(row);
+        endRemoveRows();
+    }
+    if (shown) {
+        const int newRow = shownPosition(slot);
+        beginInsertRows(QModelIndex(), newRow, newRow);
+        m_shown.insert(newRow, slot);
+        endInsertRows();
+    }
+}
+
+void ReplayTableModel::releaseSlot(int slot)
+{
+    m_slotForPath.remove(m_rows[slot].path);
+    m_rows[slot] = ReplayRow();
+    m_rows[slot].revision = ++m_revision;
+    if (slot < m_matches.size()) {
+        m_matches[slot] = false;
+    }
+    m_freeSlots.append(slot);
+}
+
+bool ReplayTableModel::matchesFilter(int slot) const
+{
+    return m_filter.isEmpty() || (slot < m_matches.size() && m_matches[slot]);
+}
+
+/**
+ * @brief Evaluates the current filter for a single row, on the GUI thread.
+ */
+void ReplayTableModel::updateMatch(int slot)
+{
+    if (m_filter.isEmpty()) {
+        return;
+    }
+    if (m_matches.size() < m_rows.size()) {
+        m_matches.resize(m_rows.size(), false);
+    }
+    m_matches[slot] = rowMatches(m_rows[slot], m_filter, [this](int term, quint32 id) {
+        return m_strings[id].contains(m_filter.terms[term].text, Qt::CaseInsensitive);
+    });
+}
+
+/**
+ * @brief Shows the result of a filter evaluation. Rows written after the evaluation started
+ * (at revision) were not seen by it and are evaluated again here.
+ */
+void ReplayTableModel::applyFilterResult(const ReplayFilter& filter, QList<bool> matches, quint64 revision)
+{
+    relayout([this, &filter, &matches, revision]() {
+        m_filter = filter;
+        if (m_filter.isEmpty()) {
+            m_matches.clear();
+        } else {
+            matches.resize(m_rows.size(), false);
+            m_matches = std::move(matches);
+            if (revision != m_revision) {
+                for (int slot = 0; slot < m_rows.size(); ++slot) {
+                    if (m_rows[slot].revision > revision) {
+                        updateMatch(slot);
+                    }
+                }
+            }
+        }
+        rebuildShown();
+    });
+
+    emit filterApplied(rowCount(), replayCount());
+}
+
+/**
+ * @brief Orders two slots ascending by a column. Ties are broken by slot number, so the order
+ * is total and a slot's position can be found again by binary search.
+ */
+bool ReplayTableModel::lessThan(int column, int slotA, int slotB) const
+{
+    const ReplayRow& a = m_rows[slotA];
+    const ReplayRow& b = m_rows[slotB];
+
+    int cmp;
+    switch (column) {
+    case PlayerColumn: cmp = compareKeys(m_collationRanks[a.playerName], m_collationRanks[b.playerName]); break;
+    case TankColumn: cmp = compareKeys(m_collationRanks[a.tank], m_collationRanks[b.tank]); break;
+    case MapColumn: cmp = compareKeys(m_collationRanks[a.map], m_collationRanks[b.map]); break;
+    // By battle time, since the dd.MM.yyyy text does not sort chronologically
+    case DateColumn: cmp = compareKeys(a.battleTime, b.battleTime); break;
+    case DamageColumn: cmp = compareKeys(a.damage, b.damage); break;
+    case ServerColumn: cmp = compareKeys(m_collationRanks[a.server], m_collationRanks[b.server]); break;
+    default: cmp = compareKeys(m_collationRanks[a.version], m_collationRanks[b.version]); break;
+    }
+    return cmp != 0 ? cmp < 0 : slotA < slotB;
+}
+
+int ReplayTableModel::permutationPosition(int column, int slot) const
+{
+    const QList<int>& permutation = m_permutations[column];
+    auto it = std::lower_bound(permutation.cbegin(), permutation.cend(), slot, [this, column](int a, int b) {
+        return lessThan(column, a, b);
+    });
+    return int(it - permutation.cbegin());
+}
+
+bool ReplayTableModel::shownBefore(int slotA, int slotB) const
+{
+    return m_sortOrder == Qt::AscendingOrder ? lessThan(m_sortColumn, slotA, slotB) : lessThan(m_sortColumn, slotB, slotA);
+}
+
+void ReplayTableModel::insertIntoPermutations(int slot)
+{
+    for (int column = 0; column < ColumnCount; ++column) {
+        if (m_permutationBuilt[column]) {
+            m_permutations[column].insert(permutationPosition(column, slot), slot);
+        }
+    }
+}
+
+void ReplayTableModel::removeFromPermutations(int slot)
+{
+    for (int column = 0; column < ColumnCount; ++column) {
+        if (!m_permutationBuilt[column]) {
+            continue;
+        }
+        QList<int>& permutation = m_permutations[column];
+        const int position = permutationPosition(column, slot);
+        if (position < permutation.size() && permutation[position] == slot) {
+            permutation.remove(position);
+        }
+    }
+}
+
+/**
+ * @brief Sorts all live slots by a column. Only needed the first time a column is shown.
+ */
+void ReplayTableModel::buildPermutation(int column)
+{
+    QList<int>& permutation = m_permutations[column];
+    permutation.clear();
+    permutation.reserve(m_slotForPath.size());
+    for (int slot : std::as_const(m_slotForPath)) {
+        permutation.append(slot);
+    }
+    std::sort(permutation.begin(), permutation.end(), [this, column](int a, int b) {
+        return lessThan(column, a, b);
+    });
+    m_permutationBuilt[column] = true;
+}
+
+/**
+ * @brief Rebuilds the shown rows from the current permutation, direction and filter matches.
+ */
+void ReplayTableModel::rebuildShown()
+{
+    const QList<int>& permutation = m_permutations[m_sortColumn];
+    m_shown.clear();
+    m_shown.reserve(m_filter.isEmpty() ? permutation.size() : 0);
+    if (m_sortOrder == Qt::AscendingOrder) {
+        for (int slot : permutation) {
+            if (matchesFilter(slot)) {
+                m_shown.append(slot);
+            }
+        }
+    } else {
+        for (auto it = permutation.crbegin(); it != permutation.crend(); ++it) {
+            if (matchesFilter(*it)) {
+                m_shown.append(*it);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Adds a new slot to every cached permutation and, if it matches the filter, announces its row.
+ */
+void ReplayTableModel::insertRow(int slot)
+{
+    insertIntoPermutations(slot);
+    updateMatch(slot);
+    if (!matchesFilter(slot)) {
+        return;
+    }
+
+    const int row = shownPosition(slot);
+    beginInsertRows(QModelIndex(), row, row);
+    m_shown.insert(row, slot);
+    endInsertRows();
+}
+
+/**
+ * @brief Runs a reorder of the shown rows inside a layout change, moving persistent indexes
+ * (the selection among them) to the new rows of their replays.
+ */
+void ReplayTableModel::relayout(const std::function<void()>& reorder)
+{
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    const QModelIndexList oldIndexes = persistentIndexList();
+    QList<int> oldSlots;
+    oldSlots.reserve(oldIndexes.size());
+    for (const QModelIndex& index : oldIndexes) {
+        oldSlots.append(slotAt(index.row()));
+    }
+
+    reorder();
+
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (int i = 0; i < oldIndexes.size(); ++i) {
+        newIndexes.append(index(rowForSlot(oldSlots[i]), oldIndexes[i].column()));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+/**
+ * @brief Returns the table row showing a slot, or -1 if it is filtered out or not live.
+ */
+int ReplayTableModel::rowForSlot(int slot) const
+{
+    const int position = shownPosition(slot);
+    if (position >= m_shown.size() || m_shown[position] != slot) {
+        return -1;
+    }
+    return position;
+}
+
+int ReplayTableModel::shownPosition(int slot) const
+{
+    auto it = std::lower_bound(m_shown.cbegin(), m_shown.cend(), slot, [this](int a, int b) {
+        return shownBefore(a, b);
+    });
+    return int(it - m_shown.cbegin());
+}
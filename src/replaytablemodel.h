@@ -0,0 +1,155 @@
+#ifndef REPLAYTABLEMODEL_H
+#define REPLAYTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCollator>
+#include <QHash>
+#include <QList>
+#include <QLocale>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "replayfilter.h"
+#include "replayscanner.h"
+
+// Table model over the in-memory replay library, shown through a QTableView.
+//
+// Every replay is one compact row: the path and date text, the numeric fields, and ids into
+// a shared pool for the heavily repeated player, tank, map, server and version strings.
+// No per-cell objects exist; data() formats the display text when the view asks for it.
+//
+// Rows live in stable slots. Each column that has been sorted by keeps a permutation of the
+// slots in ascending order of that column, built once and then maintained; the table shows the
+// current column's permutation forwards or backwards. Sorting compares precomputed typed keys
+// only: battle time, damage, and the collation rank of each pooled string.
+//
+// The shown rows are that order restricted to the replays matching the filter. Filters are
+// evaluated on a pool thread over a shared copy of the rows; a stricter filter only rechecks
+// the previous matches, one carrying full-text index matches only checks those rows, and a
+// result that was overtaken by newer input is dropped.
+//
+// New, changed and deleted replays are applied to the permutations as row inserts and
+// removals, so the view keeps its selection and scroll position and one new battle costs a
+// binary search per permutation and a single-row notification.
+class ReplayTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column { PlayerColumn, TankColumn, MapColumn, DateColumn, DamageColumn, ServerColumn, VersionColumn, ColumnCount };
+
+    explicit ReplayTableModel(QObject *parent = nullptr);
+    ~ReplayTableModel();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Replaces the whole library with a single model reset.
+    void setReplays(const QList<ReplayInfo>& replays);
+    // Inserts new replays at their sorted position and refreshes the rows of known paths.
+    void mergeReplays(const QList<ReplayInfo>& replays);
+    // Removes the rows of the given paths, one contiguous range at a time.
+    void removeReplays(const QSet<QString>& paths);
+
+    // Starts evaluating a filter in the background; filterApplied reports when it is shown.
+    void setFilter(const ReplayFilter& filter);
+    const ReplayFilter& filter() const { return m_filter; }
+
+    int replayCount() const { return int(m_slotForPath.size()); }
+    int rowForPath(const QString& path) const;
+    QString pathAt(int row) const;
+    QStringList paths() const;
+    // Every replay, filtered out or not, in the current sort order.
+    QList<ReplayInfo> replays() const;
+    // The longest display text seen in a column since the last reset, for sizing the column.
+    QString longestText(int column) const;
+
+signals:
+    void filterApplied(int shownCount, int totalCount);
+
+private:
+    // The string fields are pool ids; the numeric fields double as their sort keys
+    struct ReplayRow {
+        QString path; // Empty for a free slot
+        QString date;
+        quint32 playerName = 0;
+        quint32 tank = 0;
+        quint32 map = 0;
+        quint32 server = 0;
+        quint32 version = 0;
+        qint32 damage = 0;
+        qint64 battleTime = 0;
+        ReplayFingerprint fingerprint;
+        quint64 revision = 0; // Value of m_revision when the slot was last written
+    };
+
+    static QList<bool> evaluateFilter(const QList<ReplayRow>& rows, const QStringList& strings,
+                                      const ReplayFilter& filter, const QList<bool>& candidates,
+                                      const std::function<bool()>& cancelled);
+
+    ReplayRow makeRow(const ReplayInfo& info);
+    ReplayInfo replayFromRow(const ReplayRow& row) const;
+    quint32 intern(const QString& value);
+    void noteLength(int column, const QString& text);
+    int allocateSlot(const ReplayInfo& info);
+    void updateSlot(int slot, const ReplayInfo& info);
+    void releaseSlot(int slot);
+    bool matchesFilter(int slot) const;
+    void updateMatch(int slot);
+    void applyFilterResult(const ReplayFilter& filter, QList<bool> matches, quint64 revision);
+
+    bool lessThan(int column, int slotA, int slotB) const;
+    bool shownBefore(int slotA, int slotB) const;
+    int permutationPosition(int column, int slot) const;
+    void insertIntoPermutations(int slot);
+    void removeFromPermutations(int slot);
+    void buildPermutation(int column);
+    void rebuildShown();
+    void insertRow(int slot);
+    void relayout(const std::function<void()>& reorder);
+
+    int slotAt(int row) const { return m_shown[row]; }
+    int rowForSlot(int slot) const;
+    int shownPosition(int slot) const;
+
+    QList<ReplayRow> m_rows; // Slots; a removed replay leaves a free slot behind
+    QList<int> m_freeSlots;
+    QHash<QString, int> m_slotForPath;
+    quint64 m_revision = 0;
+
+    // Per column, the live slots in ascending order; ties are broken by slot number
+    QList<int> m_permutations[ColumnCount];
+    bool m_permutationBuilt[ColumnCount] = {};
+
+    // Table row -> slot: the current permutation in the shown direction, filtered
+    QList<int> m_shown;
+
+    ReplayFilter m_filter;
+    QList<bool> m_matches; // Slot -> matches m_filter; unused while the filter is empty
+    std::shared_ptr<std::atomic<quint64>> m_filterGeneration; // Bumped by every setFilter
+
+    // Pool of distinct strings; rows refer to them by index
+    QStringList m_strings;
+    QHash<QString, quint32> m_stringIds;
+
+    // Collation order of the pool, kept up to date as strings are interned
+    QCollator m_collator;
+    QList<QCollatorSortKey> m_collationKeys; // String id -> collation key
+    QList<quint32> m_collationOrder; // Collation rank -> string id
+    QList<quint32> m_collationRanks; // String id -> collation rank
+
+    // Per column, the text with the most characters; tracked as rows are written, never shrunk
+    QString m_longestText[ColumnCount];
+    qint32 m_maxDamage = 0;
+
+    QLocale m_locale;
+    int m_sortColumn = DateColumn;
+    Qt::SortOrder m_sortOrder = Qt::DescendingOrder;
+};
+
+#endif // REPLAYTABLEMODEL_H
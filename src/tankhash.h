@@ -0,0 +1,20 @@
+#ifndef TANKHASH_H
+#define TANKHASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Seeded FNV-style hash shared by tankmapgen and the generated lookup table.
+// Works on any character type so QString data can be hashed without converting it;
+// vehicle ids are ASCII, so char and char16_t inputs hash identically.
+template <typename Char>
+constexpr uint32_t tankIdHash(uint32_t seed, const Char* data, size_t size)
+{
+    uint32_t hash = seed ? seed : 0x01000193u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash * 0x01000193u) ^ static_cast<uint32_t>(data[i]);
+    }
+    return hash;
+}
+
+#endif // TANKHASH_H
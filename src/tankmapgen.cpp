@@ -0,0 +1,167 @@
+// Build-time generator: turns tank_mapping.json into a constexpr minimal perfect-hash table.
+// Usage: tankmapgen <tank_mapping.json> <output header>
+
+#include "json.hpp"
+#include "tankhash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+uint32_t slotFor(uint32_t seed, const std::string& key, size_t size)
+{
+    return tankIdHash(seed, key.data(), key.size()) % size;
+}
+
+// Escapes a UTF-8 string as a C++ literal; non-ASCII bytes become octal escapes.
+std::string literal(const std::string& value)
+{
+    std::string out = "\"";
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += char(c);
+        } else if (c < 0x20 || c >= 0x7f) {
+            char escaped[5];
+            std::snprintf(escaped, sizeof(escaped), "\\%03o", c);
+            out += escaped;
+        } else {
+            out += char(c);
+        }
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::cerr << "Usage: tankmapgen <tank_mapping.json> <output header>\n";
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input) {
+        std::cerr << "tankmapgen: cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    nlohmann::json mapping;
+    try {
+        input >> mapping;
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "tankmapgen: " << argv[1] << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (auto it = mapping.begin(); it != mapping.end(); ++it) {
+        if (!it.value().is_string()) {
+            std::cerr << "tankmapgen: value for " << it.key() << " is not a string\n";
+            return 1;
+        }
+        entries.emplace_back(it.key(), it.value().get<std::string>());
+    }
+    const size_t size = std::max<size_t>(entries.size(), 1);
+
+    // Hash-and-displace: bucket keys by an unseeded hash, then find a seed per bucket
+    // (largest buckets first) that sends all of its keys to free slots.
+    std::vector<std::vector<size_t>> buckets(size);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        buckets[slotFor(0, entries[i].first, size)].push_back(i);
+    }
+    std::vector<size_t> order(size);
+    for (size_t i = 0; i < size; ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<int32_t> seeds(size, 0);
+    std::vector<long> slots(size, -1); // slot -> entry index
+
+    size_t next = 0;
+    for (; next < order.size() && buckets[order[next]].size() > 1; ++next) {
+        const std::vector<size_t>& bucket = buckets[order[next]];
+        for (uint32_t seed = 1;; ++seed) {
+            if (seed > 10000000) {
+                std::cerr << "tankmapgen: no perfect hash seed found\n";
+                return 1;
+            }
+            std::vector<uint32_t> taken;
+            bool fits = true;
+            for (size_t entry : bucket) {
+                uint32_t slot = slotFor(seed, entries[entry].first, size);
+                if (slots[slot] != -1 || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+                    fits = false;
+                    break;
+                }
+                taken.push_back(slot);
+            }
+            if (fits) {
+                for (size_t k = 0; k < bucket.size(); ++k) {
+                    slots[taken[k]] = long(bucket[k]);
+                }
+                seeds[order[next]] = int32_t(seed);
+                break;
+            }
+        }
+    }
+
+    // Single-key buckets go straight into the remaining free slots, stored as -(slot + 1)
+    size_t freeSlot = 0;
+    for (; next < order.size() && buckets[order[next]].size() == 1; ++next) {
+        while (slots[freeSlot] != -1) {
+            ++freeSlot;
+        }
+        slots[freeSlot] = long(buckets[order[next]][0]);
+        seeds[order[next]] = -int32_t(freeSlot) - 1;
+    }
+
+    std::ofstream output(argv[2], std::ios::binary | std::ios::trunc);
+    if (!output) {
+        std::cerr << "tankmapgen: cannot write " << argv[2] << "\n";
+        return 1;
+    }
+
+    output << "// Generated by tankmapgen from tank_mapping.json. Do not edit.\n"
+           << "#ifndef TANKMAPPINGTABLE_H\n"
+           << "#define TANKMAPPINGTABLE_H\n\n"
+           << "#include <cstddef>\n"
+           << "#include <cstdint>\n"
+           << "#include <string_view>\n\n"
+           << "namespace TankMappingTable {\n\n"
+           << "struct Entry {\n"
+           << "    std::string_view id;\n"
+           << "    std::string_view name;\n"
+           << "};\n\n"
+           << "constexpr size_t kSize = " << size << ";\n\n"
+           << "// Per-bucket seed; negative values encode the slot directly as -(slot + 1)\n"
+           << "constexpr int32_t kSeeds[kSize] = {";
+    for (size_t i = 0; i < size; ++i) {
+        output << (i % 16 == 0 ? "\n    " : " ") << seeds[i] << ",";
+    }
+    output << "\n};\n\n"
+           << "constexpr Entry kEntries[kSize] = {\n";
+    for (size_t i = 0; i < size; ++i) {
+        if (slots[i] < 0) {
+            output << "    {{}, {}},\n";
+        } else {
+            const auto& entry = entries[size_t(slots[i])];
+            output << "    {" << literal(entry.first) << ", " << literal(entry.second) << "},\n";
+        }
+    }
+    output << "};\n\n"
+           << "} // namespace TankMappingTable\n\n"
+           << "#endif // TANKMAPPINGTABLE_H\n";
+
+    return output ? 0 : 1;
+}
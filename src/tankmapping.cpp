@@ -0,0 +1,94 @@
+#include "tankmapping.h"
+#include "tankhash.h"
+#include "tankmappingtable.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QStandardPaths>
+#include <string_view>
+
+namespace {
+
+// O(1) lookup in the generated table, hashing the QString's UTF-16 data in place.
+std::string_view builtinName(const QString& tankId)
+{
+    using namespace TankMappingTable;
+
+    const char16_t* data = reinterpret_cast<const char16_t*>(tankId.constData());
+    const size_t size = size_t(tankId.size());
+
+    const int32_t seed = kSeeds[tankIdHash(0, data, size) % kSize];
+    const size_t slot = seed < 0 ? size_t(-seed - 1) : tankIdHash(uint32_t(seed), data, size) % kSize;
+
+    const Entry& entry = kEntries[slot];
+    if (entry.id.size() != size) {
+        return {};
+    }
+    for (size_t i = 0; i < size; ++i) {
+        if (char16_t(static_cast<unsigned char>(entry.id[i])) != data[i]) {
+            return {};
+        }
+    }
+    return entry.name;
+}
+
+} // namespace
+
+TankMapping::TankMapping()
+    : m_loadTimeMs(0)
+{
+    QElapsedTimer timer;
+    timer.start();
+    loadOverrides();
+    m_loadTimeMs = timer.elapsed();
+}
+
+const TankMapping& TankMapping::instance()
+{
+    // Function-local static: initialized exactly once, even if several threads race here
+    static const TankMapping mapping;
+    return mapping;
+}
+
+QString TankMapping::displayName(const QString& tankId) const
+{
+    auto overrideIt = m_overrides.constFind(tankId);
+    if (overrideIt != m_overrides.constEnd()) {
+        return overrideIt.value();
+    }
+
+    std::string_view name = builtinName(tankId);
+    return name.empty() ? QString() : QString::fromUtf8(name.data(), qsizetype(name.size()));
+}
+
+/**
+ * @brief Loads user-supplied name corrections. Same format as tank_mapping.json; optional.
+ */
+void TankMapping::loadOverrides()
+{
+    QString overridesPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/tank_mapping_overrides.json";
+    QFile file(overridesPath);
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Failed to open tank mapping overrides:" << overridesPath;
+        return;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qDebug() << "Failed to parse tank mapping overrides:" << parseError.errorString();
+        return;
+    }
+
+    QJsonObject obj = doc.object();
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        m_overrides.insert(it.key(), it.value().toString());
+    }
+    qDebug() << "Loaded" << m_overrides.size() << "tank name overrides from" << overridesPath;
+}
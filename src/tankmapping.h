@@ -0,0 +1,37 @@
+#ifndef TANKMAPPING_H
+#define TANKMAPPING_H
+
+#include <QHash>
+#include <QString>
+
+// Vehicle id -> display name lookup. The built-in names come from a perfect-hash table that
+// tankmapgen generates from tank_mapping.json at build time; user corrections from
+// tank_mapping_overrides.json in the config directory take precedence over it.
+//
+// One immutable instance is shared by the whole process. It is created on first use
+// (thread-safe) and never modified afterwards, so scanners and their worker threads can
+// read it concurrently without locking.
+class TankMapping
+{
+public:
+    static const TankMapping& instance();
+
+    // Display name for a vehicle id such as "R04_T-34", or an empty string if it is unknown.
+    QString displayName(const QString& tankId) const;
+
+    // Time spent creating the shared instance, in milliseconds.
+    qint64 loadTimeMs() const { return m_loadTimeMs; }
+    int overrideCount() const { return int(m_overrides.size()); }
+
+    TankMapping(const TankMapping&) = delete;
+    TankMapping& operator=(const TankMapping&) = delete;
+
+private:
+    TankMapping();
+    void loadOverrides();
+
+    QHash<QString, QString> m_overrides;
+    qint64 m_loadTimeMs;
+};
+
+#endif // TANKMAPPING_H
@@ -0,0 +1,204 @@
+use std::fs::File;
+use std::io::{self, BufReader, Read};
+use std::time::{Duration, SystemTime};
+use memmap2::{Mmap, MmapOptions};
+#[cfg(unix)]
+use memmap2::Advice;
+use serde_json::Value;
+
+/// First four bytes of every .wotreplay file, read little-endian.
+const REPLAY_MAGIC: u32 = 0x1134_3212;
+/// Upper bound for one JSON block; anything larger means the header is corrupt.
+const MAX_BLOCK_SIZE: u32 = 16 * 1024 * 1024;
+/// Initial mapping size; covers the block table and the start block of almost every replay.
+const MAP_WINDOW: u64 = 64 * 1024;
+/// Files modified more recently than this may still be written to and are never mapped.
+const RECENT_WRITE_WINDOW: Duration = Duration::from_secs(10);
+
+/// Source of the JSON blocks at the start of a replay.
+pub trait HeaderBlocks {
+    /// Returns the next JSON block, or None once all header blocks have been read.
+    fn next_block(&mut self) -> io::Result<Option<Value>>;
+    /// Bytes read (or mapped) from the file so far.
+    fn bytes_read(&self) -> u64;
+}
+
+/// Counts the bytes actually pulled from the underlying file, below any buffering.
+pub struct CountingReader<R: Read> {
+    inner: R,
+    bytes_read: u64,
+}
+
+impl<R: Read> Read for CountingReader<R> {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        let n = self.inner.read(buf)?;
+        self.bytes_read += n as u64;
+        Ok(n)
+    }
+}
+
+/// Reads the JSON blocks at the start of a replay (battle start info, then battle results)
+/// without touching the encrypted packet stream that follows them.
+pub struct ReplayHeader<R: Read> {
+    reader: R,
+    remaining_blocks: u32,
+}
+
+impl ReplayHeader<BufReader<CountingReader<File>>> {
+    pub fn open(path: &str) -> io::Result<Self> {
+        let file = CountingReader { inner: File::open(path)?, bytes_read: 0 };
+        Self::new(BufReader::with_capacity(16 * 1024, file))
+    }
+
+}
+
+impl HeaderBlocks for ReplayHeader<BufReader<CountingReader<File>>> {
+    fn next_block(&mut self) -> io::Result<Option<Value>> {
+        ReplayHeader::next_block(self)
+    }
+
+    // Includes read-ahead done by the buffer
+    fn bytes_read(&self) -> u64 {
+        self.reader.get_ref().bytes_read
+    }
+}
+
+impl<R: Read> ReplayHeader<R> {
+    pub fn new(mut reader: R) -> io::Result<Self> {
+        if read_u32(&mut reader)? != REPLAY_MAGIC {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "Not a replay file"));
+        }
+        let remaining_blocks = read_u32(&mut reader)?;
+        Ok(ReplayHeader { reader, remaining_blocks })
+    }
+
+    /// Returns the next JSON block, or None once all header blocks have been read.
+    pub fn next_block(&mut self) -> io::Result<Option<Value>> {
+        if self.remaining_blocks == 0 {
+            return Ok(None);
+        }
+
+        let size = read_u32(&mut self.reader)?;
+        if size > MAX_BLOCK_SIZE {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "JSON block too large"));
+        }
+
+        let mut block = vec![0u8; size as usize];
+        self.reader.read_exact(&mut block)?;
+        self.remaining_blocks -= 1;
+
+        serde_json::from_slice(&block).map(Some).map_err(io::Error::from)
+    }
+}
+
+/// Memory-mapped variant of `ReplayHeader`. Only the prefix of the file holding the JSON
+/// blocks is mapped: one window up front, grown when a block runs past it.
+///
+/// A mapping is not protected against the file changing underneath it: if another process
+/// truncates or rewrites the file while it is mapped, reading the lost pages raises SIGBUS.
+/// `open` therefore refuses files modified within `RECENT_WRITE_WINDOW`, such as a replay the
+/// game is still recording; callers read those through `ReplayHeader` instead.
+pub struct MappedHeader {
+    file: File,
+    file_len: u64,
+    map: Mmap,
+    offset: usize,
+    remaining_blocks: u32,
+}
+
+impl MappedHeader {
+    pub fn open(path: &str) -> io::Result<Self> {
+        let file = File::open(path)?;
+        let metadata = file.metadata()?;
+        if recently_modified(&metadata) {
+            return Err(io::Error::new(io::ErrorKind::WouldBlock, "Replay may still be written"));
+        }
+        let file_len = metadata.len();
+        if file_len < 8 {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "Not a replay file"));
+        }
+
+        let map = map_prefix(&file, file_len.min(MAP_WINDOW))?;
+        if le_u32(&map[0..4]) != REPLAY_MAGIC {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "Not a replay file"));
+        }
+        let remaining_blocks = le_u32(&map[4..8]);
+
+        Ok(MappedHeader { file, file_len, map, offset: 8, remaining_blocks })
+    }
+
+    /// Makes sure the first `end` bytes of the file are mapped.
+    fn ensure_mapped(&mut self, end: u64) -> io::Result<()> {
+        if end <= self.map.len() as u64 {
+            return Ok(());
+        }
+        if end > self.file_len {
+            return Err(io::Error::new(io::ErrorKind::UnexpectedEof, "Replay header is truncated"));
+        }
+        // Grow in whole windows so the following block usually fits as well
+        let len = (end.div_ceil(MAP_WINDOW) * MAP_WINDOW).min(self.file_len);
+        self.map = map_prefix(&self.file, len)?;
+        Ok(())
+    }
+}
+
+impl HeaderBlocks for MappedHeader {
+    fn next_block(&mut self) -> io::Result<Option<Value>> {
+        if self.remaining_blocks == 0 {
+            return Ok(None);
+        }
+
+        self.ensure_mapped(self.offset as u64 + 4)?;
+        let size = le_u32(&self.map[self.offset..self.offset + 4]);
+        if size > MAX_BLOCK_SIZE {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "JSON block too large"));
+        }
+
+        let start = self.offset + 4;
+        let end = start + size as usize;
+        self.ensure_mapped(end as u64)?;
+
+        let block = serde_json::from_slice(&self.map[start..end])?;
+        self.offset = end;
+        self.remaining_blocks -= 1;
+        Ok(Some(block))
+    }
+
+    fn bytes_read(&self) -> u64 {
+        self.map.len() as u64
+    }
+}
+
+/// True if the file changed within `RECENT_WRITE_WINDOW`, or has a timestamp in the future.
+fn recently_modified(metadata: &std::fs::Metadata) -> bool {
+    match metadata.modified() {
+        Ok(modified) => SystemTime::now()
+            .duration_since(modified)
+            .map_or(true, |age| age < RECENT_WRITE_WINDOW),
+        // Without a timestamp there is no way to tell, so do not map
+        Err(_) => true,
+    }
+}
+
+fn map_prefix(file: &File, len: u64) -> io::Result<Mmap> {
+    // Safety: only as far as the file stays unchanged while mapped, which nothing enforces;
+    // see `MappedHeader`. The mapping is read-only and dropped as soon as the header is parsed.
+    let map = unsafe { MmapOptions::new().len(len as usize).map(file)? };
+    #[cfg(unix)]
+    {
+        // Hints only; failures are harmless
+        let _ = map.advise(Advice::Sequential);
+        let _ = map.advise(Advice::WillNeed);
+    }
+    Ok(map)
+}
+
+fn le_u32(bytes: &[u8]) -> u32 {
+    u32::from_le_bytes([bytes[0], bytes[1], bytes[2], bytes[3]])
+}
+
+fn read_u32<R: Read>(reader: &mut R) -> io::Result<u32> {
+    let mut bytes = [0u8; 4];
+    reader.read_exact(&mut bytes)?;
+    Ok(u32::from_le_bytes(bytes))
+}
@@ -1,62 +1,765 @@
-use std::ffi::{CString, CStr};
+use std::ffi::{CString, CStr, c_void};
 use std::os::raw::c_char;
+use std::ptr;
+use std::panic::{self, AssertUnwindSafe};
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::sync::{Arc, Mutex, OnceLock};
+use std::thread;
 use wot_replay_parser::ReplayParser;
 use serde_json::{json, Value};
 
-#[unsafe(no_mangle)]
-pub unsafe extern "C" fn parse_replay(path_to_replay_file: *const c_char) -> *const c_char {
-    let c_str = CStr::from_ptr(path_to_replay_file);
-    let path = match c_str.to_str() {
-        Ok(s) => s,
-        Err(e) => {
-            let error = format!("Failed to convert CStr to str: {}", e);
-            return CString::new(error).unwrap().into_raw();
-        }
-    };
+mod header;
+use header::{HeaderBlocks, MappedHeader, ReplayHeader};
 
-    let replay_parser = match ReplayParser::parse_file(path) {
-        Ok(r) => r,
-        Err(e) => {
-            let error = format!("Failed to parse replay: {:?}", e);
-            return CString::new(error).unwrap().into_raw();
-        }
+pub const WOT_PARSE_OK: i32 = 0;
+pub const WOT_PARSE_INVALID_PATH: i32 = 1;
+pub const WOT_PARSE_FAILED: i32 = 2;
+pub const WOT_PARSE_NO_START_JSON: i32 = 3;
+pub const WOT_PARSE_CANCELLED: i32 = 4;
+
+/// Parse flag: read only the JSON blocks at the start of the file instead of the whole replay.
+pub const WOT_PARSE_METADATA_ONLY: u32 = 1;
+/// Parse flag: also extract the battle results from the end block into `battle`.
+pub const WOT_PARSE_BATTLE_RESULTS: u32 = 2;
+
+/// Polled by batch workers before each file; returning true abandons the rest of the batch.
+/// May be called concurrently from several threads.
+pub type WotCancelCallback = Option<unsafe extern "C" fn(context: *mut c_void) -> bool>;
+
+/// UTF-8 span pointing into the storage owned by a `WotReplayResult`. Not NUL-terminated.
+#[repr(C)]
+pub struct WotReplayStr {
+    pub data: *const c_char,
+    pub size: usize,
+}
+
+/// Figures of the recording player only; `present` is false if the results have none.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct WotPersonalResult {
+    pub present: bool,
+    pub team: i32,
+    /// 1 win, 0 draw, -1 loss
+    pub outcome: i32,
+    pub xp: i32,
+    pub credits: i32,
+    pub kills: i32,
+    pub damage_dealt: i32,
+    pub damage_assisted_radio: i32,
+    pub damage_assisted_track: i32,
+    pub spotted: i32,
+    pub damage_received: i32,
+    pub shots: i32,
+    pub direct_hits: i32,
+    pub piercings: i32,
+    /// Seconds
+    pub life_time: i32,
+}
+
+/// Statistics of one player's vehicle in a battle.
+#[repr(C)]
+pub struct WotBattleParticipant {
+    pub vehicle_id: i64,
+    pub account_db_id: i64,
+    pub name: WotReplayStr,
+    pub clan: WotReplayStr,
+    /// "nation:tag", e.g. "ussr:R04_T-34"
+    pub vehicle: WotReplayStr,
+    pub team: i32,
+    pub damage_dealt: i32,
+    pub kills: i32,
+    pub xp: i32,
+    pub spotted: i32,
+    /// Radio plus track assistance
+    pub damage_assisted: i32,
+    pub survived: bool,
+}
+
+/// Battle results extracted from the end block; `present` is false unless requested and present.
+/// `participants` is owned by the enclosing `WotReplayResult`.
+#[repr(C)]
+pub struct WotBattleResults {
+    pub present: bool,
+    /// Exceeds 2^53, so it is passed as text
+    pub arena_unique_id: WotReplayStr,
+    pub arena_type_id: i32,
+    pub winner_team: i32,
+    pub finish_reason: i32,
+    /// Seconds
+    pub duration: i32,
+    pub personal: WotPersonalResult,
+    pub participants: *mut WotBattleParticipant,
+    pub participant_count: usize,
+}
+
+/// Fixed-layout parse result filled by `parse_replay_into`.
+/// All spans point into `storage`; `storage` and the participant array are released by
+/// `free_replay_result`.
+#[repr(C)]
+pub struct WotReplayResult {
+    pub status: i32,
+    pub player_name: WotReplayStr,
+    pub tank: WotReplayStr,
+    pub map: WotReplayStr,
+    pub date: WotReplayStr,
+    pub server: WotReplayStr,
+    pub version: WotReplayStr,
+    pub error: WotReplayStr,
+    pub battle: WotBattleResults,
+    pub damage: i64,
+    pub bytes_read: u64,
+    pub storage: *mut u8,
+    pub storage_size: usize,
+}
+
+/// The handful of fields the replay table needs, extracted from the start/end JSON blocks.
+struct ReplaySummary {
+    player_name: String,
+    tank: String,
+    map: String,
+    date: String,
+    damage: i64,
+    server: String,
+    version: String,
+    battle: Option<BattleSummary>,
+    bytes_read: u64,
+}
+
+/// Owned form of `WotBattleParticipant`, before its strings are packed into the result storage.
+struct ParticipantSummary {
+    vehicle_id: i64,
+    account_db_id: i64,
+    name: String,
+    clan: String,
+    vehicle: String,
+    team: i32,
+    damage_dealt: i32,
+    kills: i32,
+    xp: i32,
+    spotted: i32,
+    damage_assisted: i32,
+    survived: bool,
+}
+
+/// Owned form of `WotBattleResults`.
+struct BattleSummary {
+    arena_unique_id: String,
+    arena_type_id: i32,
+    winner_team: i32,
+    finish_reason: i32,
+    duration: i32,
+    personal: WotPersonalResult,
+    participants: Vec<ParticipantSummary>,
+}
+
+/// Battle-results damage for replays whose start block does not carry damageDealt.
+fn damage_from_end(end: &Value) -> i64 {
+    end.as_array()
+        .and_then(|arr| arr.first())
+        .and_then(|block| block.get("personal"))
+        .and_then(|personal| personal.as_object())
+        .and_then(|vehicles| vehicles.values().next())
+        .and_then(|vehicle| vehicle.get("damageDealt"))
+        .and_then(|dmg| dmg.as_i64())
+        .unwrap_or(0)
+}
+
+/// Personal result of the recording player: the first `personal` entry that is not the avatar.
+fn personal_vehicle(results: &Value) -> Option<&Value> {
+    results
+        .get("personal")?
+        .as_object()?
+        .iter()
+        .find(|(key, _)| key.as_str() != "avatar")
+        .map(|(_, vehicle)| vehicle)
+}
+
+/// Reduces the end block to the battle, personal and per-participant figures the cache stores.
+/// Returns `None` for incomplete replays without results.
+fn battle_results_from_end(end: &Value) -> Option<BattleSummary> {
+    let blocks = end.as_array()?;
+    let results = blocks.first()?;
+    let vehicle_info = blocks.get(1);
+    let common = results.get("common");
+
+    let int = |value: Option<&Value>, key: &str| {
+        value.and_then(|v| v.get(key)).and_then(|v| v.as_i64()).unwrap_or(0)
+    };
+    let int32 = |value: Option<&Value>, key: &str| int(value, key) as i32;
+    let text = |value: Option<&Value>, key: &str| {
+        value.and_then(|v| v.get(key)).and_then(|v| v.as_str()).unwrap_or("").to_owned()
     };
 
-    let start = match replay_parser.replay_json_start() {
-        Ok(v) => v,
-        Err(e) => {
-            let error = format!("Failed to get start JSON: {:?}", e);
-            return CString::new(error).unwrap().into_raw();
+    let winner_team = int32(common, "winnerTeam");
+    let mut personal = WotPersonalResult::empty();
+    if let Some(vehicle) = personal_vehicle(results) {
+        let vehicle = Some(vehicle);
+        let team = int32(vehicle, "team");
+        personal = WotPersonalResult {
+            present: true,
+            team,
+            outcome: if winner_team == 0 { 0 } else if winner_team == team { 1 } else { -1 },
+            xp: int32(vehicle, "xp"),
+            credits: int32(vehicle, "credits"),
+            kills: int32(vehicle, "kills"),
+            damage_dealt: int32(vehicle, "damageDealt"),
+            damage_assisted_radio: int32(vehicle, "damageAssistedRadio"),
+            damage_assisted_track: int32(vehicle, "damageAssistedTrack"),
+            spotted: int32(vehicle, "spotted"),
+            damage_received: int32(vehicle, "damageReceived"),
+            shots: int32(vehicle, "shots"),
+            direct_hits: int32(vehicle, "directHits"),
+            piercings: int32(vehicle, "piercings"),
+            life_time: int32(vehicle, "lifeTime"),
+        };
+    }
+
+    let players = results.get("players");
+    let mut participants = Vec::new();
+    if let Some(vehicles) = results.get("vehicles").and_then(|v| v.as_object()) {
+        participants.reserve(vehicles.len());
+        for (vehicle_id, entries) in vehicles {
+            // One entry per vehicle in random battles; only the first carries the totals we keep
+            let Some(vehicle) = entries.as_array().and_then(|a| a.first()) else { continue };
+            let vehicle = Some(vehicle);
+            let account_id = int(vehicle, "accountDBID");
+            let player = players.and_then(|p| p.get(account_id.to_string()));
+            let info = vehicle_info.and_then(|v| v.get(vehicle_id));
+            participants.push(ParticipantSummary {
+                vehicle_id: vehicle_id.parse::<i64>().unwrap_or(0),
+                account_db_id: account_id,
+                name: text(player.or(info), "name"),
+                clan: text(player.or(info), "clanAbbrev"),
+                vehicle: text(info, "vehicleType"),
+                team: int32(vehicle, "team"),
+                damage_dealt: int32(vehicle, "damageDealt"),
+                kills: int32(vehicle, "kills"),
+                xp: int32(vehicle, "xp"),
+                spotted: int32(vehicle, "spotted"),
+                damage_assisted: int32(vehicle, "damageAssistedRadio") + int32(vehicle, "damageAssistedTrack"),
+                survived: int(vehicle, "deathReason") == -1,
+            });
         }
+    }
+
+    // arenaUniqueID exceeds 2^53 and may be stored either way; keep its digits as text
+    let arena_unique_id = match results.get("arenaUniqueID") {
+        Some(Value::String(s)) => s.clone(),
+        Some(other) => other.to_string(),
+        None => String::new(),
     };
 
-    let replay_json_end: Option<Value> = replay_parser.replay_json_end().map(|v| v.clone());
+    Some(BattleSummary {
+        arena_unique_id,
+        arena_type_id: int32(common, "arenaTypeID"),
+        winner_team,
+        finish_reason: int32(common, "finishReason"),
+        duration: int32(common, "duration"),
+        personal,
+        participants,
+    })
+}
 
+/// Builds the summary from the start block; `end_damage` is only called when the start block has no damage.
+fn build_summary(start: &Value, end_damage: impl FnOnce() -> i64) -> ReplaySummary {
     let mut damage = start.get("damageDealt").and_then(|v| v.as_i64()).unwrap_or(0);
     //println!("Rust Parser: Damage from start JSON: {}", damage);
 
     if damage == 0 {
-        damage = replay_json_end
-            .as_ref()
-            .and_then(|end| end.as_array())
-            .and_then(|arr| arr.first())
-            .and_then(|block| block.get("personal"))
-            .and_then(|personal| personal.as_object())
-            .and_then(|vehicles| vehicles.values().next())
-            .and_then(|vehicle| vehicle.get("damageDealt"))
-            .and_then(|dmg| dmg.as_i64())
-            .unwrap_or(0);
+        damage = end_damage();
+    }
+
+    let field = |key: &str| start.get(key).and_then(|v| v.as_str()).unwrap_or("").to_owned();
+
+    ReplaySummary {
+        player_name: field("playerName"),
+        tank: field("playerVehicle"),
+        map: field("mapDisplayName"),
+        date: field("dateTime"),
+        damage,
+        server: field("serverName"),
+        version: field("clientVersionFromXml"),
+        battle: None,
+        bytes_read: 0,
+    }
+}
+
+/// Metadata-only path: reads the block-count header and the JSON blocks, never the packet payload.
+/// Uses a memory map of the header region, or buffered reads where mapping is not possible
+/// or the file was modified too recently to be mapped safely.
+fn summarize_header(path: &str, flags: u32) -> std::io::Result<ReplaySummary> {
+    match MappedHeader::open(path) {
+        Ok(header) => summarize_blocks(header, flags),
+        Err(_) => summarize_blocks(ReplayHeader::open(path)?, flags),
+    }
+}
+
+fn summarize_blocks(mut header: impl HeaderBlocks, flags: u32) -> std::io::Result<ReplaySummary> {
+    let start = header
+        .next_block()?
+        .ok_or_else(|| std::io::Error::new(std::io::ErrorKind::InvalidData, "Replay has no JSON blocks"))?;
+
+    // The end block is only read when something needs it, and then borrowed from here
+    let mut end: Option<Option<Value>> = None;
+    let mut summary = build_summary(&start, || read_end(&mut end, &mut header).map(damage_from_end).unwrap_or(0));
+    if flags & WOT_PARSE_BATTLE_RESULTS != 0 {
+        summary.battle = read_end(&mut end, &mut header).and_then(battle_results_from_end);
+    }
+    summary.bytes_read = header.bytes_read();
+    Ok(summary)
+}
+
+/// Reads the end block on first use and returns the cached block afterwards.
+fn read_end<'a>(end: &'a mut Option<Option<Value>>, header: &mut impl HeaderBlocks) -> Option<&'a Value> {
+    end.get_or_insert_with(|| header.next_block().ok().flatten()).as_ref()
+}
+
+fn summarize_replay(path: &str, flags: u32) -> Result<ReplaySummary, (i32, String)> {
+    if flags & WOT_PARSE_METADATA_ONLY != 0 {
+        // Fall back to the full parser for anything the header reader does not understand
+        if let Ok(summary) = summarize_header(path, flags) {
+            return Ok(summary);
+        }
+    }
+
+    let replay_parser = ReplayParser::parse_file(path)
+        .map_err(|e| (WOT_PARSE_FAILED, format!("Failed to parse replay: {:?}", e)))?;
+
+    let start = replay_parser
+        .replay_json_start()
+        .map_err(|e| (WOT_PARSE_NO_START_JSON, format!("Failed to get start JSON: {:?}", e)))?;
+
+    let replay_json_end = replay_parser.replay_json_end();
+
+    let mut summary = build_summary(&start, || replay_json_end.map(damage_from_end).unwrap_or(0));
+    if flags & WOT_PARSE_BATTLE_RESULTS != 0 {
+        summary.battle = replay_json_end.and_then(battle_results_from_end);
+    }
+    // The full parser reads the whole file
+    summary.bytes_read = std::fs::metadata(path).map(|m| m.len()).unwrap_or(0);
+    Ok(summary)
+}
+
+impl WotReplayStr {
+    const fn empty() -> Self {
+        WotReplayStr { data: ptr::null(), size: 0 }
+    }
+}
+
+impl WotPersonalResult {
+    const fn empty() -> Self {
+        WotPersonalResult {
+            present: false,
+            team: 0,
+            outcome: 0,
+            xp: 0,
+            credits: 0,
+            kills: 0,
+            damage_dealt: 0,
+            damage_assisted_radio: 0,
+            damage_assisted_track: 0,
+            spotted: 0,
+            damage_received: 0,
+            shots: 0,
+            direct_hits: 0,
+            piercings: 0,
+            life_time: 0,
+        }
+    }
+}
+
+impl WotBattleResults {
+    const fn empty() -> Self {
+        WotBattleResults {
+            present: false,
+            arena_unique_id: WotReplayStr::empty(),
+            arena_type_id: 0,
+            winner_team: 0,
+            finish_reason: 0,
+            duration: 0,
+            personal: WotPersonalResult::empty(),
+            participants: ptr::null_mut(),
+            participant_count: 0,
+        }
+    }
+}
+
+impl WotReplayResult {
+    const fn empty() -> Self {
+        WotReplayResult {
+            status: WOT_PARSE_CANCELLED,
+            player_name: WotReplayStr::empty(),
+            tank: WotReplayStr::empty(),
+            map: WotReplayStr::empty(),
+            date: WotReplayStr::empty(),
+            server: WotReplayStr::empty(),
+            version: WotReplayStr::empty(),
+            error: WotReplayStr::empty(),
+            battle: WotBattleResults::empty(),
+            damage: 0,
+            bytes_read: 0,
+            storage: ptr::null_mut(),
+            storage_size: 0,
+        }
+    }
+
+    /// Packs `fields` into one allocation and returns the span of each field inside it.
+    fn pack(&mut self, fields: &[&str]) -> Vec<WotReplayStr> {
+        let total: usize = fields.iter().map(|f| f.len()).sum();
+        let mut buffer = Vec::with_capacity(total);
+        for f in fields {
+            buffer.extend_from_slice(f.as_bytes());
+        }
+
+        let storage = Box::into_raw(buffer.into_boxed_slice()) as *mut u8;
+        self.storage = storage;
+        self.storage_size = total;
+
+        let mut offset = 0;
+        fields
+            .iter()
+            .map(|f| {
+                let span = WotReplayStr {
+                    data: unsafe { storage.add(offset) } as *const c_char,
+                    size: f.len(),
+                };
+                offset += f.len();
+                span
+            })
+            .collect()
+    }
+
+    fn fill(&mut self, summary: &ReplaySummary) {
+        // The battle's strings share the one allocation, after the six summary fields
+        let mut fields: Vec<&str> = vec![
+            &summary.player_name,
+            &summary.tank,
+            &summary.map,
+            &summary.date,
+            &summary.server,
+            &summary.version,
+        ];
+        if let Some(battle) = &summary.battle {
+            fields.push(&battle.arena_unique_id);
+            for participant in &battle.participants {
+                fields.extend([participant.name.as_str(), &participant.clan, &participant.vehicle]);
+            }
+        }
+
+        let mut spans = self.pack(&fields).into_iter();
+        let mut next = || spans.next().unwrap_or(WotReplayStr::empty());
+        self.player_name = next();
+        self.tank = next();
+        self.map = next();
+        self.date = next();
+        self.server = next();
+        self.version = next();
+
+        if let Some(battle) = &summary.battle {
+            let arena_unique_id = next();
+            let participants: Box<[WotBattleParticipant]> = battle
+                .participants
+                .iter()
+                .map(|p| WotBattleParticipant {
+                    vehicle_id: p.vehicle_id,
+                    account_db_id: p.account_db_id,
+                    name: next(),
+                    clan: next(),
+                    vehicle: next(),
+                    team: p.team,
+                    damage_dealt: p.damage_dealt,
+                    kills: p.kills,
+                    xp: p.xp,
+                    spotted: p.spotted,
+                    damage_assisted: p.damage_assisted,
+                    survived: p.survived,
+                })
+                .collect();
+            self.battle = WotBattleResults {
+                present: true,
+                arena_unique_id,
+                arena_type_id: battle.arena_type_id,
+                winner_team: battle.winner_team,
+                finish_reason: battle.finish_reason,
+                duration: battle.duration,
+                personal: battle.personal,
+                participant_count: participants.len(),
+                participants: Box::into_raw(participants) as *mut WotBattleParticipant,
+            };
+        }
+
+        self.damage = summary.damage;
+        self.bytes_read = summary.bytes_read;
+        self.status = WOT_PARSE_OK;
+    }
+
+    fn fail(&mut self, status: i32, message: &str) {
+        let mut spans = self.pack(&[message]).into_iter();
+        self.error = spans.next().unwrap_or(WotReplayStr::empty());
+        self.status = status;
+    }
+
+    /// Parses the replay at `path_to_replay_file` into this (empty) result and returns its status.
+    unsafe fn parse_from(&mut self, path_to_replay_file: *const c_char, flags: u32) -> i32 {
+        if path_to_replay_file.is_null() {
+            self.fail(WOT_PARSE_INVALID_PATH, "Path is null");
+            return self.status;
+        }
+
+        let c_str = unsafe { CStr::from_ptr(path_to_replay_file) };
+        match c_str.to_str() {
+            Ok(path) => match summarize_replay(path, flags) {
+                Ok(summary) => self.fill(&summary),
+                Err((status, message)) => self.fail(status, &message),
+            },
+            Err(e) => self.fail(WOT_PARSE_INVALID_PATH, &format!("Failed to convert CStr to str: {}", e)),
+        }
+        self.status
+    }
+
+    /// `parse_from`, with a panic in the parser reported as `WOT_PARSE_FAILED`. Letting it
+    /// unwind would abort the process at the `extern "C"` boundary on the calling thread.
+    unsafe fn parse_catching(&mut self, path_to_replay_file: *const c_char, flags: u32) -> i32 {
+        let parsed = panic::catch_unwind(AssertUnwindSafe(|| unsafe { self.parse_from(path_to_replay_file, flags) }));
+        if parsed.is_err() {
+            unsafe { self.release() };
+            self.fail(WOT_PARSE_FAILED, "Replay parser panicked");
+        }
+        self.status
+    }
+
+    /// Frees whatever storage this result holds and resets it to empty.
+    /// The pointers must have been set by `fill` or `fail`.
+    unsafe fn release(&mut self) {
+        if !self.storage.is_null() {
+            unsafe {
+                drop(Box::from_raw(ptr::slice_from_raw_parts_mut(self.storage, self.storage_size)));
+            }
+        }
+        if !self.battle.participants.is_null() {
+            unsafe {
+                drop(Box::from_raw(ptr::slice_from_raw_parts_mut(
+                    self.battle.participants,
+                    self.battle.participant_count,
+                )));
+            }
+        }
+        *self = WotReplayResult::empty();
+    }
+}
+
+/// Raw pointer wrapper so batch workers can share the caller's arrays.
+/// Sound because every index is claimed by exactly one worker.
+#[derive(Clone, Copy)]
+struct SharedPtr<T>(*mut T);
+unsafe impl<T> Send for SharedPtr<T> {}
+unsafe impl<T> Sync for SharedPtr<T> {}
+
+impl<T> SharedPtr<T> {
+    // Accessed through a method so closures capture the wrapper, not the raw pointer field
+    fn get(&self) -> *mut T {
+        self.0
+    }
+}
+
+/// Parses a replay into the caller-owned `out`, with all strings stored in a single allocation.
+/// Returns `WOT_PARSE_OK` on success; otherwise `out.error` describes the failure.
+/// `free_replay_result` must be called on `out` in both cases.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn parse_replay_into(path_to_replay_file: *const c_char, flags: u32, out: *mut WotReplayResult) -> i32 {
+    if out.is_null() {
+        return WOT_PARSE_INVALID_PATH;
+    }
+    let out = unsafe { &mut *out };
+    *out = WotReplayResult::empty();
+    unsafe { out.parse_catching(path_to_replay_file, flags) }
+}
+
+/// One `parse_replays` call, shared by the calling thread and the pool workers it enlists.
+/// Workers claim indices from `next_index` until the batch runs out or is cancelled.
+struct ReplayBatch {
+    paths: SharedPtr<*const c_char>,
+    results: SharedPtr<WotReplayResult>,
+    count: usize,
+    flags: u32,
+    should_cancel: WotCancelCallback,
+    context: SharedPtr<c_void>,
+    next_index: AtomicUsize,
+    parsed: AtomicUsize,
+    cancelled: AtomicBool,
+}
+
+impl ReplayBatch {
+    fn run(&self) {
+        loop {
+            let i = self.next_index.fetch_add(1, Ordering::Relaxed);
+            if i >= self.count || self.cancelled.load(Ordering::Relaxed) {
+                break;
+            }
+            if let Some(cancel) = self.should_cancel {
+                if unsafe { cancel(self.context.get()) } {
+                    self.cancelled.store(true, Ordering::Relaxed);
+                    break;
+                }
+            }
+            unsafe {
+                let result = &mut *self.results.get().add(i);
+                result.parse_catching(*self.paths.get().add(i), self.flags);
+            }
+            self.parsed.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+}
+
+type Job = Box<dyn FnOnce() + Send>;
+
+/// Library threads kept alive between batches, so a scan does not start fresh OS threads
+/// for every `parse_replays` call. Idle workers block on the shared job queue.
+struct WorkerPool {
+    jobs: Mutex<(Sender<Job>, usize)>, // Queue and number of workers started so far
+    queue: Arc<Mutex<Receiver<Job>>>,
+}
+
+impl WorkerPool {
+    fn get() -> &'static WorkerPool {
+        static POOL: OnceLock<WorkerPool> = OnceLock::new();
+        POOL.get_or_init(|| {
+            let (sender, receiver) = mpsc::channel();
+            WorkerPool { jobs: Mutex::new((sender, 0)), queue: Arc::new(Mutex::new(receiver)) }
+        })
     }
 
+    /// Queues `jobs`, first growing the pool to at least as many workers as there are jobs.
+    /// If not even one worker can be started, the jobs are dropped unrun.
+    fn submit(&self, jobs: Vec<Job>) {
+        let mut state = self.jobs.lock().unwrap();
+        while state.1 < jobs.len() {
+            let queue = Arc::clone(&self.queue);
+            let spawned = thread::Builder::new()
+                .name(format!("wot-parser-{}", state.1))
+                .spawn(move || loop {
+                    // The guard is dropped at the end of the statement, before the job runs
+                    let job = queue.lock().unwrap().recv();
+                    match job {
+                        // Parser panics are caught per file; this only keeps the worker alive
+                        Ok(job) => {
+                            let _ = panic::catch_unwind(AssertUnwindSafe(job));
+                        }
+                        Err(_) => break,
+                    }
+                });
+            if spawned.is_err() {
+                break;
+            }
+            state.1 += 1;
+        }
+        // With no worker to read the queue, dropping the jobs is what tells the caller they are done
+        if state.1 == 0 {
+            return;
+        }
+        for job in jobs {
+            let _ = state.0.send(job);
+        }
+    }
+}
+
+/// Parses `count` replays on up to `thread_count` library threads, writing `results[i]` for
+/// `paths[i]`. Files not reached because `should_cancel` fired keep `WOT_PARSE_CANCELLED`.
+/// Returns the number of files actually parsed. `free_replay_result` must be called on every
+/// one of the `count` results.
+///
+/// The calling thread parses too; the other threads come from a pool that is started on first
+/// use and reused by later calls.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn parse_replays(
+    paths: *const *const c_char,
+    count: usize,
+    results: *mut WotReplayResult,
+    flags: u32,
+    thread_count: usize,
+    should_cancel: WotCancelCallback,
+    cancel_context: *mut c_void,
+) -> usize {
+    if paths.is_null() || results.is_null() || count == 0 {
+        return 0;
+    }
+
+    for i in 0..count {
+        unsafe { results.add(i).write(WotReplayResult::empty()) };
+    }
+
+    let batch = Arc::new(ReplayBatch {
+        paths: SharedPtr(paths as *mut *const c_char),
+        results: SharedPtr(results),
+        count,
+        flags,
+        should_cancel,
+        context: SharedPtr(cancel_context),
+        next_index: AtomicUsize::new(0),
+        parsed: AtomicUsize::new(0),
+        cancelled: AtomicBool::new(false),
+    });
+
+    // Each helper holds a sender until its job ends, even by panicking; the channel
+    // disconnects only then, so the caller's arrays outlive every access
+    let helpers = thread_count.clamp(1, count) - 1;
+    let (done, finished) = mpsc::channel::<()>();
+    let jobs: Vec<Job> = (0..helpers)
+        .map(|_| {
+            let batch = Arc::clone(&batch);
+            let done = done.clone();
+            Box::new(move || {
+                let _done = done;
+                batch.run();
+            }) as Job
+        })
+        .collect();
+    if !jobs.is_empty() {
+        WorkerPool::get().submit(jobs);
+    }
+    drop(done);
+
+    batch.run();
+    let _ = finished.recv();
+
+    batch.parsed.load(Ordering::Relaxed)
+}
+
+/// Releases the storage of a result filled by `parse_replay_into` and resets it to empty.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn free_replay_result(result: *mut WotReplayResult) {
+    if result.is_null() {
+        return;
+    }
+    unsafe { (*result).release() };
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn parse_replay(path_to_replay_file: *const c_char) -> *const c_char {
+    let c_str = CStr::from_ptr(path_to_replay_file);
+    let path = match c_str.to_str() {
+        Ok(s) => s,
+        Err(e) => {
+            let error = format!("Failed to convert CStr to str: {}", e);
+            return CString::new(error).unwrap().into_raw();
+        }
+    };
+
+    let summary = match summarize_replay(path, 0) {
+        Ok(s) => s,
+        Err((_, error)) => return CString::new(error).unwrap().into_raw(),
+    };
+
     let flattened = json!({
         "path": path,
-        "playerName": start.get("playerName").and_then(|v| v.as_str()).unwrap_or(""),
-        "tank": start.get("playerVehicle").and_then(|v| v.as_str()).unwrap_or(""),
-        "map": start.get("mapDisplayName").and_then(|v| v.as_str()).unwrap_or(""),
-        "date": start.get("dateTime").and_then(|v| v.as_str()).unwrap_or(""),
-        "damage": damage,
-        "server": start.get("serverName").and_then(|v| v.as_str()).unwrap_or(""),
-        "version": start.get("clientVersionFromXml").and_then(|v| v.as_str()).unwrap_or("")
+        "playerName": summary.player_name,
+        "tank": summary.tank,
+        "map": summary.map,
+        "date": summary.date,
+        "damage": summary.damage,
+        "server": summary.server,
+        "version": summary.version
     });
 
     let json_string = serde_json::to_string_pretty(&flattened).unwrap();
@@ -0,0 +1,119 @@
+#ifndef WOTPARSER_H
+#define WOTPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// C interface of the Rust wot_parser_lib. Layouts must match the #[repr(C)] structs in lib.rs.
+extern "C" {
+
+enum WotParseStatus : int32_t {
+    WOT_PARSE_OK = 0,
+    WOT_PARSE_INVALID_PATH = 1,
+    WOT_PARSE_FAILED = 2,
+    WOT_PARSE_NO_START_JSON = 3,
+    WOT_PARSE_CANCELLED = 4
+};
+
+// Parse flags
+enum WotParseFlags : uint32_t {
+    WOT_PARSE_FULL = 0,
+    // Read only the JSON blocks at the start of the file, never the packet stream.
+    // Files older than a few seconds are memory-mapped; truncating or rewriting one while it
+    // is being parsed crashes the process with SIGBUS. Recently modified files are read instead.
+    WOT_PARSE_METADATA_ONLY = 1,
+    // Also extract the end-of-battle results into WotReplayResult::battle
+    WOT_PARSE_BATTLE_RESULTS = 2
+};
+
+// Polled by batch workers before each file; returning true abandons the rest of the batch.
+// May be called concurrently from several library threads.
+typedef bool (*WotCancelCallback)(void* context);
+
+// UTF-8 span into the storage of a WotReplayResult. Not NUL-terminated.
+struct WotReplayStr {
+    const char* data;
+    size_t size;
+};
+
+// Figures of the recording player only; `present` is false if the results have none.
+struct WotPersonalResult {
+    bool present;
+    int32_t team;
+    int32_t outcome; // 1 win, 0 draw, -1 loss
+    int32_t xp;
+    int32_t credits;
+    int32_t kills;
+    int32_t damage_dealt;
+    int32_t damage_assisted_radio;
+    int32_t damage_assisted_track;
+    int32_t spotted;
+    int32_t damage_received;
+    int32_t shots;
+    int32_t direct_hits;
+    int32_t piercings;
+    int32_t life_time; // Seconds
+};
+
+// Statistics of one player's vehicle in a battle.
+struct WotBattleParticipant {
+    int64_t vehicle_id;
+    int64_t account_db_id;
+    WotReplayStr name;
+    WotReplayStr clan;
+    WotReplayStr vehicle; // "nation:tag", e.g. "ussr:R04_T-34"
+    int32_t team;
+    int32_t damage_dealt;
+    int32_t kills;
+    int32_t xp;
+    int32_t spotted;
+    int32_t damage_assisted; // Radio plus track assistance
+    bool survived;
+};
+
+// End-of-battle results; `present` is false unless requested and found in the replay.
+struct WotBattleResults {
+    bool present;
+    WotReplayStr arena_unique_id; // Exceeds 2^53, so passed as text
+    int32_t arena_type_id;
+    int32_t winner_team;
+    int32_t finish_reason;
+    int32_t duration; // Seconds
+    WotPersonalResult personal;
+    WotBattleParticipant* participants; // Owned by the enclosing WotReplayResult
+    size_t participant_count;
+};
+
+// Filled by parse_replay_into; every span points into `storage`.
+struct WotReplayResult {
+    int32_t status;
+    WotReplayStr player_name;
+    WotReplayStr tank;
+    WotReplayStr map;
+    WotReplayStr date;
+    WotReplayStr server;
+    WotReplayStr version;
+    WotReplayStr error;
+    WotBattleResults battle;
+    int64_t damage;
+    uint64_t bytes_read; // Bytes read from disk for this replay
+    uint8_t* storage;
+    size_t storage_size;
+};
+
+// Parses a replay into a caller-owned result. free_replay_result must be called afterwards,
+// whether or not parsing succeeded.
+int32_t parse_replay_into(const char* path_to_replay_file, uint32_t flags, WotReplayResult* out);
+void free_replay_result(WotReplayResult* result);
+
+// Parses `count` replays on up to `thread_count` library threads, filling results[i] for paths[i].
+// Returns the number of files parsed; free_replay_result must be called on all `count` results.
+size_t parse_replays(const char* const* paths, size_t count, WotReplayResult* results, uint32_t flags,
+                     size_t thread_count, WotCancelCallback should_cancel, void* cancel_context);
+
+// Legacy interface returning the summary as a JSON string, released with free_string.
+const char* parse_replay(const char* path_to_replay_file);
+void free_string(char* s);
+}
+
+#endif // WOTPARSER_H